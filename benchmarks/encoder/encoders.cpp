@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "polo/communicator/wire.hpp"
+#include "polo/encoder.hpp"
+
+template <class Function> double nanoseconds(Function &&f, const int repeats) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++)
+    f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         repeats;
+}
+
+template <class Encoder>
+void run(const std::string &name, Encoder encoder, const std::vector<double> &x,
+         const double density, const int masters) {
+  const int d = x.size();
+  const int repeats = std::max(3, int(2E7 / d));
+  const double *xb = x.data();
+  const double *xe = x.data() + x.size();
+
+  const auto result = encoder(xb, xe);
+  const double encode = nanoseconds([&]() { encoder(xb, xe); }, repeats);
+
+  std::vector<double> decoded(d);
+  const double decode = nanoseconds(
+      [&]() { result(std::begin(decoded), std::end(decoded)); }, repeats);
+
+  const double slice = nanoseconds(
+      [&]() {
+        const int split = d / masters, remain = d % masters;
+        int indstart{0};
+        for (int m = 0; m < masters; m++) {
+          const int indend = indstart + split + (m < remain);
+          result.slice(indstart, indend);
+          indstart = indend;
+        }
+      },
+      repeats);
+
+  double error{0}, norm{0};
+  for (int idx = 0; idx < d; idx++) {
+    error += (decoded[idx] - x[idx]) * (decoded[idx] - x[idx]);
+    norm += x[idx] * x[idx];
+  }
+
+  const std::size_t bytes = polo::communicator::wire::size(result);
+  std::cout << name << ',' << d << ',' << density << ',' << masters << ','
+            << encode << ',' << decode << ',' << slice << ',' << bytes << ','
+            << 8.0 * bytes / d << ','
+            << (norm > 0 ? std::sqrt(error / norm) : 0) << '\n';
+}
+
+int main(int argc, char *argv[]) {
+  const int masters = argc > 1 ? std::atoi(argv[1]) : 8;
+  const std::vector<int> dimensions{10000, 100000, 1000000, 10000000};
+  const std::vector<double> densities{1.0, 0.1, 0.01};
+
+  std::mt19937 gen;
+  std::normal_distribution<double> normal;
+  std::uniform_real_distribution<double> uniform;
+
+  std::cout << "encoder,dimension,density,masters,encode_ns,decode_ns,"
+               "slice_ns,bytes,bits_per_coordinate,relative_error\n";
+  for (const int d : dimensions) {
+    const int k = std::max(1, d / 100);
+    for (const double density : densities) {
+      std::vector<double> x(d);
+      for (double &val : x)
+        val = uniform(gen) < density ? normal(gen) : 0;
+
+      run("identity", polo::encoder::identity<double, int>{}, x, density,
+          masters);
+      run("topk", polo::encoder::topk<double, int>{k}, x, density, masters);
+      run("random_sparsifier",
+          polo::encoder::random_sparsifier<double, int>{std::size_t(d), 0.01},
+          x, density, masters);
+      run("ternary", polo::encoder::ternary<double, int>{}, x, density,
+          masters);
+      run("dynamic", polo::encoder::dynamic<double, int>{}, x, density,
+          masters);
+      run("random_quantizer", polo::encoder::random_quantizer<double, int>{},
+          x, density, masters);
+      run("qsgd2", polo::encoder::qsgd<double, int, 2>{1, 512}, x, density,
+          masters);
+      run("qsgd4", polo::encoder::qsgd<double, int, 4>{7, 512}, x, density,
+          masters);
+      run("qsgd8", polo::encoder::qsgd<double, int, 8>{127}, x, density,
+          masters);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "polo/encoder/topk.hpp"
+
+template <class Function> double nanoseconds(Function &&f, const int repeats) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++)
+    f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         repeats;
+}
+
+int main() {
+  using polo::encoder::selection;
+  const std::vector<int> dimensions{100000, 1000000, 10000000};
+  const std::vector<double> ratios{0.0001, 0.001, 0.01};
+  const std::vector<std::pair<std::string, selection>> methods{
+      {"heap", selection::heap},
+      {"exact", selection::exact},
+      {"sampled", selection::sampled},
+      {"chunked", selection::chunked}};
+
+  std::mt19937 gen;
+  std::normal_distribution<double> dist;
+
+  std::cout << "method,dimension,k,ns_per_call,achieved_k,recall\n";
+  for (const int d : dimensions) {
+    std::vector<double> x(d), expected(d), actual(d);
+    for (double &val : x)
+      val = dist(gen);
+    const int repeats = std::max(3, int(1E8 / d));
+
+    for (const double ratio : ratios) {
+      const int k = std::max(1, int(ratio * d));
+      polo::encoder::topk<double, int> reference(k, selection::heap);
+      reference(std::begin(x), std::end(x))(std::begin(expected),
+                                            std::end(expected));
+
+      for (const auto &method : methods) {
+        polo::encoder::topk<double, int> encoder(k, method.second);
+        const double ns = nanoseconds(
+            [&]() { encoder(std::begin(x), std::end(x)); }, repeats);
+
+        encoder(std::begin(x), std::end(x))(std::begin(actual),
+                                            std::end(actual));
+        int achieved{0}, hits{0};
+        for (int idx = 0; idx < d; idx++) {
+          achieved += actual[idx] != 0;
+          hits += (actual[idx] != 0) & (expected[idx] != 0);
+        }
+
+        std::cout << method.first << ',' << d << ',' << k << ',' << ns << ','
+                  << achieved << ',' << double(hits) / k << '\n';
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "polo/polo.hpp"
+
+using namespace polo;
+using namespace polo::execution::paramserver;
+
+template <template <class, class> class execution>
+using algorithm_t =
+    algorithm::proxgradient<double, int, boosting::none, step::constant,
+                            smoothing::none, prox::none, execution>;
+
+double microseconds(const int d, const int masters, const int iterations) {
+  auto loss = [d](const double *x, double *g) {
+    double f{0};
+    for (int idx = 0; idx < d; idx++) {
+      g[idx] = x[idx] - 1;
+      f += 0.5 * g[idx] * g[idx];
+    }
+    return f;
+  };
+
+  options opts;
+  opts.num_masters(masters);
+  opts.master("127.0.0.1", 41000);
+  opts.scheduler("127.0.0.1", 40100, 40101, 40102);
+  opts.timeout(2000);
+  opts.worker_timeout(2000);
+
+  const std::vector<double> x0(d, 0);
+  double seconds{0};
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() {
+    algorithm_t<scheduler> alg;
+    alg.execution_parameters(opts);
+    alg.initialize(x0);
+    const auto start = std::chrono::steady_clock::now();
+    alg.solve(loss, utility::detail::null{},
+              terminator::iteration<double, int>{iterations});
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  });
+  for (int m = 0; m < masters; m++)
+    threads.emplace_back([&]() {
+      algorithm_t<master> alg;
+      alg.execution_parameters(opts);
+      alg.step_parameters(0.05);
+      alg.initialize(x0);
+      alg.solve(loss);
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  threads.emplace_back([&]() {
+    algorithm_t<worker> alg;
+    alg.execution_parameters(opts);
+    alg.initialize(x0);
+    alg.solve(loss);
+  });
+  for (auto &thread : threads)
+    thread.join();
+
+  return 1E6 * seconds / iterations;
+}
+
+// Round trips of a d-value reply from a ROUTER, the way workers pull from a
+// master over localhost. With fresh, every request opens, connects and
+// closes its own REQ socket, which is what workers did before they kept one
+// DEALER per master.
+double roundtrip(const int d, const bool fresh, const int requests) {
+  const communicator::zmq::context ctx;
+  communicator::zmq::socket router(ctx, communicator::zmq::socket_type::router);
+  router.bind("tcp://127.0.0.1:*");
+  char endpoint[256];
+  router.get(communicator::zmq::socket_opt::last_endpoint, endpoint);
+
+  std::thread server([&]() {
+    const auto xdata = detail::serialize(std::vector<double>(d));
+    communicator::zmq::message msg;
+    for (int r = 0; r < requests; r++) {
+      msg.receive(router);
+      msg.pop_back();
+      msg.addpart(xdata);
+      msg.send(router);
+    }
+  });
+
+  communicator::zmq::socket dealer;
+  if (!fresh) {
+    dealer = communicator::zmq::socket{ctx,
+                                       communicator::zmq::socket_type::dealer};
+    dealer.connect(endpoint);
+  }
+
+  communicator::zmq::message msg;
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < requests; r++) {
+    msg.clear();
+    if (fresh) {
+      communicator::zmq::socket req(ctx, communicator::zmq::socket_type::req);
+      req.connect(endpoint);
+      msg.addpart('x');
+      msg.send(req);
+      msg.receive(req);
+    } else {
+      msg.addpart(std::uint32_t(r));
+      msg.addpart();
+      msg.addpart('x');
+      msg.send(dealer);
+      msg.receive(dealer);
+    }
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  server.join();
+
+  return 1E6 * seconds / requests;
+}
+
+int main() {
+  const std::vector<int> dimensions{1000, 100000};
+  const std::vector<int> masters{1, 4};
+  const int iterations{2000};
+
+  std::cout << "dimension,connection,us_per_pull\n";
+  for (const int d : dimensions)
+    for (const bool fresh : {true, false})
+      std::cout << d << ',' << (fresh ? "fresh" : "persistent") << ','
+                << roundtrip(d, fresh, iterations) << '\n';
+
+  std::cout << "\ndimension,masters,us_per_iteration\n";
+  for (const int d : dimensions)
+    for (const int m : masters)
+      std::cout << d << ',' << m << ',' << microseconds(d, m, iterations)
+                << '\n';
+
+  return 0;
+}
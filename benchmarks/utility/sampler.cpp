@@ -0,0 +1,66 @@
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "polo/utility/sampler.hpp"
+
+template <class OutputIt>
+OutputIt reference(std::uniform_int_distribution<int> &dist, std::mt19937 &gen,
+                   OutputIt sbegin, OutputIt send) {
+  int val;
+  std::set<int> values;
+  const size_t d = std::distance(sbegin, send);
+  while (values.size() != d) {
+    do {
+      val = dist(gen);
+    } while (values.count(val) == 1);
+    values.insert(val);
+  }
+  for (const int val : values)
+    *sbegin++ = val;
+  return sbegin;
+}
+
+template <class Function> double nanoseconds(Function &&f, const int repeats) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++)
+    f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         repeats;
+}
+
+int main() {
+  const std::vector<int> populations{10000, 1000000};
+  const std::vector<double> ratios{0.0001, 0.001, 0.01, 0.1, 0.5, 0.9, 1.0};
+
+  std::cout << "sampler,population,batch,ns_per_call\n";
+  for (const int n : populations) {
+    for (const double ratio : ratios) {
+      const int b = std::max(1, int(ratio * n));
+      const int repeats = std::max(5, int(2E7 / (n + b * 20)));
+      std::vector<int> indices(b);
+
+      polo::utility::sampler::uniform<int> sampler;
+      sampler.parameters(0, n - 1);
+      const double floyd = nanoseconds(
+          [&]() { sampler(std::begin(indices), std::end(indices)); }, repeats);
+
+      std::mt19937 gen;
+      std::uniform_int_distribution<int> dist(0, n - 1);
+      const double rejection = nanoseconds(
+          [&]() {
+            reference(dist, gen, std::begin(indices), std::end(indices));
+          },
+          ratio > 0.5 ? 1 : repeats);
+
+      std::cout << "uniform," << n << ',' << b << ',' << floyd << '\n';
+      std::cout << "reference," << n << ',' << b << ',' << rejection << '\n';
+    }
+  }
+
+  return 0;
+}
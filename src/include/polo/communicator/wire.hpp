@@ -0,0 +1,271 @@
+#ifndef POLO_COMMUNICATOR_WIRE_HPP_
+#define POLO_COMMUNICATOR_WIRE_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace polo {
+namespace communicator {
+namespace wire {
+template <class T> struct span {
+  span() = default;
+  span(const T *first, const T *last) : first(first), last(last) {}
+
+  const T *begin() const noexcept { return first; }
+  const T *end() const noexcept { return last; }
+  std::size_t size() const noexcept { return last - first; }
+
+private:
+  const T *first{nullptr}, *last{nullptr};
+};
+
+template <class T> span<T> make_span(const T *first, const T *last) {
+  return span<T>(first, last);
+}
+
+namespace detail {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+constexpr bool native = false;
+#else
+constexpr bool native = true;
+#endif
+
+inline std::size_t align(const std::size_t offset,
+                         const std::size_t alignment) noexcept {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+inline void swap(char *data, const std::size_t width, const std::size_t n) {
+  if (native || width == 1)
+    return;
+  for (std::size_t idx = 0; idx < n; idx++, data += width)
+    std::reverse(data, data + width);
+}
+
+template <class T, class Archive, class = void>
+struct has_serialize : std::false_type {};
+template <class T, class Archive>
+struct has_serialize<T, Archive,
+                     decltype(std::declval<T &>().serialize(
+                                  std::declval<Archive &>()),
+                              void())> : std::true_type {};
+
+template <class T> struct is_sequence : std::false_type {};
+template <class T, class A>
+struct is_sequence<std::vector<T, A>> : std::true_type {};
+template <class T> struct is_sequence<span<T>> : std::true_type {};
+
+template <class Archive> struct archive {
+  template <class... Ts> Archive &operator()(Ts &&... values) {
+    int expand[] = {0, (self().process(std::forward<Ts>(values)), 0)...};
+    (void)expand;
+    return self();
+  }
+
+private:
+  Archive &self() noexcept { return static_cast<Archive &>(*this); }
+};
+} // namespace detail
+
+struct sizer : detail::archive<sizer> {
+  std::size_t size() const noexcept { return offset; }
+
+private:
+  friend struct detail::archive<sizer>;
+
+  template <class T>
+  typename std::enable_if<std::is_arithmetic<T>::value>::type
+  process(const T &) {
+    offset = detail::align(offset, sizeof(T)) + sizeof(T);
+  }
+  template <class T>
+  typename std::enable_if<detail::is_sequence<T>::value>::type
+  process(const T &values) {
+    using value_type = typename std::decay<decltype(*values.begin())>::type;
+    process(std::uint64_t{});
+    sequence(values, std::is_arithmetic<value_type>{});
+  }
+  template <class T>
+  typename std::enable_if<!std::is_arithmetic<T>::value &&
+                          !detail::is_sequence<T>::value>::type
+  process(const T &value) {
+    object(value, detail::has_serialize<T, sizer>{});
+  }
+
+  template <class T> void sequence(const T &values, std::true_type) {
+    using value_type = typename std::decay<decltype(*values.begin())>::type;
+    offset = detail::align(offset, sizeof(value_type)) +
+             values.size() * sizeof(value_type);
+  }
+  template <class T> void sequence(const T &values, std::false_type) {
+    for (const auto &value : values)
+      process(value);
+  }
+
+  template <class T> void object(const T &value, std::true_type) {
+    const_cast<T &>(value).serialize(*this);
+  }
+  template <class T> void object(const T &value, std::false_type) {
+    value.save(*this);
+  }
+
+  std::size_t offset{0};
+};
+
+struct writer : detail::archive<writer> {
+  writer(void *buffer, const std::size_t capacity)
+      : buffer(static_cast<char *>(buffer)), capacity(capacity) {}
+
+  std::size_t size() const noexcept { return offset; }
+
+private:
+  friend struct detail::archive<writer>;
+
+  template <class T>
+  typename std::enable_if<std::is_arithmetic<T>::value>::type
+  process(const T &value) {
+    write(&value, sizeof(T), 1);
+  }
+  template <class T>
+  typename std::enable_if<detail::is_sequence<T>::value>::type
+  process(const T &values) {
+    using value_type = typename std::decay<decltype(*values.begin())>::type;
+    process(std::uint64_t(values.size()));
+    sequence(values, std::is_arithmetic<value_type>{});
+  }
+  template <class T>
+  typename std::enable_if<!std::is_arithmetic<T>::value &&
+                          !detail::is_sequence<T>::value>::type
+  process(const T &value) {
+    object(value, detail::has_serialize<T, writer>{});
+  }
+
+  template <class T> void sequence(const T &values, std::true_type) {
+    using value_type = typename std::decay<decltype(*values.begin())>::type;
+    write(values.size() == 0 ? nullptr : &*values.begin(), sizeof(value_type),
+          values.size());
+  }
+  template <class T> void sequence(const T &values, std::false_type) {
+    for (const auto &value : values)
+      process(value);
+  }
+
+  template <class T> void object(const T &value, std::true_type) {
+    const_cast<T &>(value).serialize(*this);
+  }
+  template <class T> void object(const T &value, std::false_type) {
+    value.save(*this);
+  }
+
+  void write(const void *data, const std::size_t width, const std::size_t n) {
+    const std::size_t start = detail::align(offset, width);
+    if (start + width * n > capacity)
+      throw std::range_error("wire: buffer too small");
+    std::fill(buffer + offset, buffer + start, 0);
+    if (n > 0) {
+      std::memcpy(buffer + start, data, width * n);
+      detail::swap(buffer + start, width, n);
+    }
+    offset = start + width * n;
+  }
+
+  char *buffer;
+  std::size_t capacity, offset{0};
+};
+
+// Reads what a writer wrote. Buffers that end early throw std::range_error,
+// as do writers that run out of room, so that callers can tell malformed
+// payloads apart from other failures.
+struct reader : detail::archive<reader> {
+  reader(const void *buffer, const std::size_t capacity)
+      : buffer(static_cast<const char *>(buffer)), capacity(capacity) {}
+
+  std::size_t size() const noexcept { return offset; }
+
+  template <class T, class OutputIt> OutputIt extract(OutputIt out) {
+    std::uint64_t n;
+    process(n);
+    const char *data = claim(sizeof(T), n);
+    T value;
+    for (std::uint64_t idx = 0; idx < n; idx++, data += sizeof(T)) {
+      std::memcpy(&value, data, sizeof(T));
+      detail::swap(reinterpret_cast<char *>(&value), sizeof(T), 1);
+      *out++ = value;
+    }
+    return out;
+  }
+
+private:
+  friend struct detail::archive<reader>;
+
+  template <class T>
+  typename std::enable_if<std::is_arithmetic<T>::value>::type
+  process(T &value) {
+    std::memcpy(&value, claim(sizeof(T), 1), sizeof(T));
+    detail::swap(reinterpret_cast<char *>(&value), sizeof(T), 1);
+  }
+  template <class T, class A> void process(std::vector<T, A> &values) {
+    std::uint64_t n;
+    process(n);
+    sequence(values, n, std::is_arithmetic<T>{});
+  }
+  template <class T>
+  typename std::enable_if<!std::is_arithmetic<T>::value &&
+                          !detail::is_sequence<T>::value>::type
+  process(T &value) {
+    object(value, detail::has_serialize<T, reader>{});
+  }
+
+  template <class T, class A>
+  void sequence(std::vector<T, A> &values, const std::uint64_t n,
+                std::true_type) {
+    const char *data = claim(sizeof(T), n);
+    values.resize(n);
+    if (n > 0) {
+      std::memcpy(values.data(), data, sizeof(T) * n);
+      detail::swap(reinterpret_cast<char *>(values.data()), sizeof(T), n);
+    }
+  }
+  template <class T, class A>
+  void sequence(std::vector<T, A> &values, const std::uint64_t n,
+                std::false_type) {
+    values.resize(n);
+    for (auto &value : values)
+      process(value);
+  }
+
+  template <class T> void object(T &value, std::true_type) {
+    value.serialize(*this);
+  }
+  template <class T> void object(T &value, std::false_type) {
+    value.load(*this);
+  }
+
+  const char *claim(const std::size_t width, const std::uint64_t n) {
+    const std::size_t start = detail::align(offset, width);
+    if (start > capacity || n > (capacity - start) / width)
+      throw std::range_error("wire: truncated buffer");
+    offset = start + width * n;
+    return buffer + start;
+  }
+
+  const char *buffer;
+  std::size_t capacity, offset{0};
+};
+
+template <class T> std::size_t size(const T &value) {
+  sizer ar;
+  ar(value);
+  return ar.size();
+}
+} // namespace wire
+} // namespace communicator
+} // namespace polo
+
+#endif
@@ -87,7 +87,6 @@ private:
 };
 
 struct message {
-private:
   struct part {
     part() noexcept;
     explicit part(std::size_t);
@@ -120,6 +119,7 @@ private:
     zmq_msg_t msg_;
   };
 
+private:
   std::vector<part> parts_;
 
 public:
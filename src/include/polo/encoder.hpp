@@ -2,7 +2,10 @@
 #define POLO_ENCODER_HPP_
 
 #include "polo/encoder/dynamic.hpp"
+#include "polo/encoder/encode.hpp"
+#include "polo/encoder/error_feedback.hpp"
 #include "polo/encoder/identity.hpp"
+#include "polo/encoder/qsgd.hpp"
 #include "polo/encoder/random_quantizer.hpp"
 #include "polo/encoder/random_sparsifier.hpp"
 #include "polo/encoder/ternary.hpp"
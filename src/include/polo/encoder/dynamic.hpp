@@ -6,11 +6,11 @@
 #include <cmath>
 #include <cstdint>
 #include <iterator>
-#include <queue>
 #include <utility>
 #include <vector>
 
 #include "cereal/types/vector.hpp"
+#include "polo/encoder/indices.hpp"
 
 namespace polo {
 namespace encoder {
@@ -22,38 +22,26 @@ template <class value_t, class index_t, class bit_t = uint8_t> class dynamic {
         : norm(norm), nzind(std::move(nzind)), signs(std::move(signs)) {}
 
     size_t size() const noexcept {
-      return sizeof(value_t) + sizeof(index_t) * nzind.size() +
-             sizeof(bit_t) * signs.size();
+      const std::size_t offset = detail::packed_indices<index_t>::size(
+          nzind, detail::scalar_end<value_t>(0));
+      return detail::sequence_end<bit_t>(offset, signs.size());
     }
 
-    template <class Archive> void serialize(Archive &archive) {
-      archive(norm, nzind, signs);
+    template <class Archive> void save(Archive &archive) const {
+      archive(norm, detail::packed_indices<index_t>(nzind), signs);
+    }
+    template <class Archive> void load(Archive &archive) {
+      detail::packed_indices<index_t> indices;
+      archive(norm, indices, signs);
+      indices.decode_into(nzind);
     }
 
     result_t slice(const index_t ib, const index_t ie) const {
-      const size_t nbits = CHAR_BIT * sizeof(bit_t);
-      const size_t N = nbits / 2;
-
-      std::vector<index_t> newind;
-      std::vector<bit_t> newsigns;
-
-      if (!nzind.empty() && ib <= nzind.back()) {
-        index_t k{0}, newk{0};
-        for (const index_t idx : nzind) {
-          if ((idx >= ib) & (idx < ie)) {
-            newind.push_back(idx);
-            const int val = (signs[k / N] >> (2 * (k % N))) & 3;
-            if (newk % N == 0)
-              newsigns.push_back(0);
-            newsigns[newk / N] |= (val << (2 * (newk % N)));
-            newk++;
-          } else if (idx >= ie)
-            break;
-          k++;
-        }
-      }
-
-      return result_t(norm, std::move(newind), std::move(newsigns));
+      const auto range = detail::slice_bounds(nzind, ib, ie);
+      return result_t(norm,
+                      std::vector<index_t>(std::begin(nzind) + range.first,
+                                           std::begin(nzind) + range.second),
+                      detail::slice_codes(signs, range.first, range.second));
     }
 
     template <class OutputIt>
@@ -74,132 +62,117 @@ template <class value_t, class index_t, class bit_t = uint8_t> class dynamic {
     }
 
   private:
+    friend class dynamic;
+
     value_t norm;
     std::vector<index_t> nzind;
     std::vector<bit_t> signs;
   };
 
+  mutable std::vector<index_t> heap;
+
 public:
   using result_type = result_t;
 
   template <class RandomIt>
   result_type operator()(RandomIt xb, RandomIt xe) const {
+    result_type result;
+    operator()(xb, xe, result);
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
+                         ForwardIt ie) const {
+    result_type result;
+    operator()(xb, xe, ib, ie, result);
+    return result;
+  }
+
+  template <class RandomIt>
+  result_type &operator()(RandomIt xb, RandomIt xe,
+                          result_type &result) const {
     const auto cmp = [xb](const index_t left, const index_t right) {
       return std::abs(*(xb + left)) > std::abs(*(xb + right));
     };
-    std::priority_queue<index_t, std::vector<index_t>, decltype(cmp)> heap(cmp);
 
     index_t k{0};
     const size_t K(std::ceil(std::sqrt(std::distance(xb, xe))));
     value_t norm{0};
+    heap.clear();
     RandomIt xtemp{xb};
     while (xtemp != xe) {
       const value_t val = *xtemp++;
-      if (heap.size() < K)
-        heap.push(k);
-      else if (std::abs(val) > std::abs(*(xb + heap.top()))) {
-        heap.pop();
-        heap.push(k);
+      if (heap.size() < K) {
+        heap.push_back(k);
+        std::push_heap(std::begin(heap), std::end(heap), cmp);
+      } else if (std::abs(val) > std::abs(*(xb + heap.front()))) {
+        std::pop_heap(std::begin(heap), std::end(heap), cmp);
+        heap.back() = k;
+        std::push_heap(std::begin(heap), std::end(heap), cmp);
       }
       norm += val * val;
       k++;
     }
-    norm = std::sqrt(norm);
-
-    std::vector<index_t> indices(K);
-    std::generate(indices.rbegin(), indices.rend(), [&heap]() {
-      const index_t idx = heap.top();
-      heap.pop();
-      return idx;
-    });
-
-    const size_t nbits = CHAR_BIT * sizeof(bit_t);
-    const size_t N = nbits / 2;
-
-    std::vector<index_t> nzind;
-    std::vector<bit_t> signs;
-
-    k = 0;
-    value_t acc{0};
-    while (acc < norm) {
-      const index_t idx = indices[k];
-      const value_t val = *(xb + idx);
-      acc += std::abs(val);
-      k++;
-    }
-    std::sort(std::begin(indices), std::begin(indices) + k);
-
-    for (index_t curr = 0; curr < k; curr++) {
-      const index_t idx = indices[curr];
-      nzind.push_back(idx);
-      const value_t val = *(xb + idx);
-      if (curr % N == 0)
-        signs.push_back(0);
-      signs[curr / N] |=
-          (val < 0) ? (1 << (2 * (curr % N))) : (2 << (2 * (curr % N)));
-    }
+    result.norm = std::sqrt(norm);
+    std::sort_heap(std::begin(heap), std::end(heap), cmp);
 
-    return result_type(norm, std::move(nzind), std::move(signs));
+    return pack(xb, result);
   }
 
   template <class RandomIt, class ForwardIt>
-  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
-                         ForwardIt ie) const {
+  result_type &operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie,
+                          result_type &result) const {
     const auto cmp = [xb](const index_t left, const index_t right) {
       return std::abs(*(xb + left)) > std::abs(*(xb + right));
     };
-    std::priority_queue<index_t, std::vector<index_t>, decltype(cmp)> heap(cmp);
 
     const size_t K(std::ceil(std::sqrt(std::distance(ib, ie))));
     value_t norm{0};
+    heap.clear();
     ForwardIt itemp{ib};
     while (itemp != ie) {
       const index_t idx = *itemp++;
       const value_t val = *(xb + idx);
-      if (heap.size() < K)
-        heap.push(idx);
-      else if (std::abs(val) > std::abs(*(xb + heap.top()))) {
-        heap.pop();
-        heap.push(idx);
+      if (heap.size() < K) {
+        heap.push_back(idx);
+        std::push_heap(std::begin(heap), std::end(heap), cmp);
+      } else if (std::abs(val) > std::abs(*(xb + heap.front()))) {
+        std::pop_heap(std::begin(heap), std::end(heap), cmp);
+        heap.back() = idx;
+        std::push_heap(std::begin(heap), std::end(heap), cmp);
       }
       norm += val * val;
     }
-    norm = std::sqrt(norm);
+    result.norm = std::sqrt(norm);
+    std::sort_heap(std::begin(heap), std::end(heap), cmp);
 
-    std::vector<index_t> indices(K);
-    std::generate(indices.rbegin(), indices.rend(), [&heap]() {
-      const index_t idx = heap.top();
-      heap.pop();
-      return idx;
-    });
+    return pack(xb, result);
+  }
 
+private:
+  template <class RandomIt>
+  result_type &pack(RandomIt xb, result_type &result) const {
     const size_t nbits = CHAR_BIT * sizeof(bit_t);
     const size_t N = nbits / 2;
 
-    std::vector<index_t> nzind;
-    std::vector<bit_t> signs;
-
-    index_t k{0};
+    std::size_t k{0};
     value_t acc{0};
-    while (acc < norm) {
-      const index_t idx = indices[k];
-      const value_t val = *(xb + idx);
-      acc += std::abs(val);
-      k++;
-    }
-    std::sort(std::begin(indices), std::begin(indices) + k);
-
-    for (index_t curr = 0; curr < k; curr++) {
-      const index_t idx = indices[curr];
-      nzind.push_back(idx);
-      const value_t val = *(xb + idx);
-      if (curr % N == 0)
-        signs.push_back(0);
+    while (acc < result.norm && k < heap.size())
+      acc += std::abs(*(xb + heap[k++]));
+    std::sort(std::begin(heap), std::begin(heap) + k);
+
+    std::vector<index_t> &nzind = result.nzind;
+    std::vector<bit_t> &signs = result.signs;
+    nzind.assign(std::begin(heap), std::begin(heap) + k);
+    signs.assign((k + N - 1) / N, 0);
+    for (std::size_t curr = 0; curr < k; curr++) {
+      const value_t val = *(xb + nzind[curr]);
       signs[curr / N] |=
           (val < 0) ? (1 << (2 * (curr % N))) : (2 << (2 * (curr % N)));
     }
 
-    return result_type(norm, std::move(nzind), std::move(signs));
+    return result;
   }
 };
 } // namespace encoder
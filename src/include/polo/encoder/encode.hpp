@@ -0,0 +1,26 @@
+#ifndef POLO_ENCODER_ENCODE_HPP_
+#define POLO_ENCODER_ENCODE_HPP_
+
+namespace polo {
+namespace encoder {
+namespace detail {
+template <class Encoder, class Result, class... Args>
+auto encode(Encoder &encoder, Result &result, int, Args... args)
+    -> decltype(encoder(args..., result), void()) {
+  encoder(args..., result);
+}
+template <class Encoder, class Result, class... Args>
+void encode(Encoder &encoder, Result &result, long, Args... args) {
+  result = encoder(args...);
+}
+} // namespace detail
+
+template <class Encoder, class Result, class... Args>
+Result &encode(Encoder &encoder, Result &result, Args... args) {
+  detail::encode(encoder, result, 0, args...);
+  return result;
+}
+} // namespace encoder
+} // namespace polo
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef POLO_ENCODER_ERROR_FEEDBACK_HPP_
+#define POLO_ENCODER_ERROR_FEEDBACK_HPP_
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "polo/encoder/encode.hpp"
+
+namespace polo {
+namespace encoder {
+template <class value_t, class index_t, class Encoder> class error_feedback {
+  mutable Encoder encoder;
+  mutable std::vector<value_t> residual, corrected, decoded;
+
+  void prepare(const std::size_t d) const {
+    if (residual.size() != d) {
+      residual = std::vector<value_t>(d);
+      corrected = std::vector<value_t>(d);
+      decoded = std::vector<value_t>(d);
+    }
+  }
+
+public:
+  using result_type = typename Encoder::result_type;
+
+  error_feedback(Encoder encoder) : encoder(std::move(encoder)) {}
+
+  const std::vector<value_t> &memory() const noexcept { return residual; }
+  void reset() { std::fill(std::begin(residual), std::end(residual), 0); }
+
+  template <class RandomIt>
+  result_type operator()(RandomIt xb, RandomIt xe) const {
+    result_type result;
+    operator()(xb, xe, result);
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
+                         ForwardIt ie) const {
+    result_type result;
+    operator()(xb, xe, ib, ie, result);
+    return result;
+  }
+
+  template <class RandomIt>
+  result_type &operator()(RandomIt xb, RandomIt xe,
+                          result_type &result) const {
+    prepare(std::distance(xb, xe));
+    std::transform(xb, xe, std::begin(residual), std::begin(corrected),
+                   std::plus<value_t>());
+
+    const value_t *cb = corrected.data();
+    const value_t *ce = cb + corrected.size();
+    encode(encoder, result, cb, ce);
+    result(std::begin(decoded), std::end(decoded));
+
+    std::transform(std::begin(corrected), std::end(corrected),
+                   std::begin(decoded), std::begin(residual),
+                   std::minus<value_t>());
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type &operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie,
+                          result_type &result) const {
+    prepare(std::distance(xb, xe));
+    for (ForwardIt itemp = ib; itemp != ie; itemp++)
+      corrected[*itemp] = *(xb + *itemp) + residual[*itemp];
+
+    const value_t *cb = corrected.data();
+    const value_t *ce = cb + corrected.size();
+    encode(encoder, result, cb, ce, ib, ie);
+    result(std::begin(decoded), std::end(decoded));
+
+    for (ForwardIt itemp = ib; itemp != ie; itemp++)
+      residual[*itemp] = corrected[*itemp] - decoded[*itemp];
+    return result;
+  }
+};
+} // namespace encoder
+} // namespace polo
+
+#endif
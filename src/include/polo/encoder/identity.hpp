@@ -3,9 +3,11 @@
 
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
 #include <vector>
 
 #include "cereal/types/vector.hpp"
+#include "polo/encoder/indices.hpp"
 
 namespace polo {
 namespace encoder {
@@ -18,7 +20,7 @@ template <class value_t, class index_t> class identity {
       const size_t d = this->x.size();
       xb = this->x.data();
       xe = xb + d;
-      ib = (this->indices.size() == d) ? indices.data() : nullptr;
+      ib = (this->indices.size() == d) ? this->indices.data() : nullptr;
       ie = (this->indices.size() == d) ? ib + d : nullptr;
     }
     result_t(const value_t *xb, const value_t *xe) : xb(xb), xe(xe) {}
@@ -27,8 +29,11 @@ template <class value_t, class index_t> class identity {
         : xb(xb), xe(xe), ib(ib), ie(ie) {}
 
     size_t size() const noexcept {
-      return sizeof(value_t) * std::distance(xb, xe) +
-             sizeof(index_t) * std::distance(ib, ie);
+      const size_t d =
+          (ib == nullptr) ? std::distance(xb, xe) : std::distance(ib, ie);
+      const size_t n = (ib == nullptr) ? indices.size() : d;
+      return detail::sequence_end<index_t>(detail::sequence_end<value_t>(0, d),
+                                           n);
     }
 
     template <class Archive> void load(Archive &archive) {
@@ -70,44 +75,21 @@ template <class value_t, class index_t> class identity {
 
     result_t slice(const index_t ib, const index_t ie) const {
       if (!indices.empty()) {
-        std::vector<index_t> newind;
-        std::vector<value_t> newval;
-        if (ib <= indices.back()) {
-          index_t k{0};
-          for (const index_t idx : indices) {
-            if ((idx >= ib) & (idx < ie)) {
-              newind.push_back(idx);
-              newval.push_back(x[k]);
-            } else if (idx >= ie)
-              break;
-            k++;
-          }
-        }
-        return result_t(std::move(newval), std::move(newind));
-      } else if (!x.empty()) {
-        std::vector<index_t> newind;
-        std::vector<value_t> newval;
-        for (index_t idx = ib; idx < ie; idx++) {
-          newind.push_back(idx);
-          newval.push_back(x[idx]);
-        }
-        return result_t(std::move(newval), std::move(newind));
-      } else if (this->ib != nullptr) {
-        const index_t *newb{this->ib};
-        while (*newb < ib)
-          newb++;
-        const index_t *newe{newb};
-        while ((*newe < ie) & (newe != this->ie))
-          newe++;
+        const auto range = detail::slice_bounds(indices, ib, ie);
+        return result_t(
+            std::vector<value_t>(std::begin(x) + range.first,
+                                 std::begin(x) + range.second),
+            std::vector<index_t>(std::begin(indices) + range.first,
+                                 std::begin(indices) + range.second));
+      } else if (!x.empty())
+        return result_t(
+            std::vector<value_t>(std::begin(x) + ib, std::begin(x) + ie));
+      else if (this->ib != nullptr) {
+        const index_t *newb = std::lower_bound(this->ib, this->ie, ib);
+        const index_t *newe = std::lower_bound(newb, this->ie, ie);
         return result_t(xb, xe, newb, newe);
-      } else {
-        std::vector<index_t> newind(ie - ib);
-        index_t idx = ib;
-        std::generate(std::begin(newind), std::end(newind),
-                      [&]() { return idx++; });
-        std::vector<value_t> newval(xb + ib, xb + ie);
-        return result_t(std::move(newval), std::move(newind));
-      }
+      } else
+        return result_t(xb + ib, xb + ie);
     }
 
     template <class OutputIt>
@@ -120,18 +102,34 @@ template <class value_t, class index_t> class identity {
       } else if (!x.empty())
         std::copy(std::begin(x), std::end(x), xb);
       else if (this->ib != nullptr) {
-        std::fill(xb, xe, 0);
+        OutputIt xtemp{xb};
         const index_t *itemp{this->ib};
         while (itemp != ie) {
           const index_t idx = *itemp++;
-          *(xb + idx - ib) = *(this->xb + idx - ib);
+          xtemp = std::fill_n(xtemp, std::distance(xtemp, xb + (idx - ib)), 0);
+          *xtemp++ = *(this->xb + idx);
         }
-      } else
+        std::fill(xtemp, xe, 0);
+      } else if (!aliases(xb))
         std::copy(this->xb, this->xe, xb);
       return xe;
     }
 
   private:
+    friend class identity;
+
+    template <class OutputIt> bool aliases(const OutputIt &out) const noexcept {
+      return aliases(out, std::is_convertible<OutputIt, const value_t *>{});
+    }
+    template <class OutputIt>
+    bool aliases(const OutputIt &out, std::true_type) const noexcept {
+      return static_cast<const value_t *>(out) == xb;
+    }
+    template <class OutputIt>
+    bool aliases(const OutputIt &, std::false_type) const noexcept {
+      return false;
+    }
+
     const value_t *xb{nullptr};
     const value_t *xe{nullptr};
     const index_t *ib{nullptr};
@@ -153,6 +151,30 @@ public:
                          const index_t *ib, const index_t *ie) const {
     return result_type(xb, xe, ib, ie);
   }
+
+  result_type &operator()(const value_t *xb, const value_t *xe,
+                          result_type &result) const {
+    return assign(result, xb, xe, nullptr, nullptr);
+  }
+
+  result_type &operator()(const value_t *xb, const value_t *xe,
+                          const index_t *ib, const index_t *ie,
+                          result_type &result) const {
+    return assign(result, xb, xe, ib, ie);
+  }
+
+private:
+  static result_type &assign(result_type &result, const value_t *xb,
+                             const value_t *xe, const index_t *ib,
+                             const index_t *ie) {
+    result.x.clear();
+    result.indices.clear();
+    result.xb = xb;
+    result.xe = xe;
+    result.ib = ib;
+    result.ie = ie;
+    return result;
+  }
 };
 } // namespace encoder
 } // namespace polo
@@ -0,0 +1,399 @@
+#ifndef POLO_ENCODER_INDICES_HPP_
+#define POLO_ENCODER_INDICES_HPP_
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace polo {
+namespace encoder {
+namespace detail {
+inline std::uint64_t zigzag(const std::int64_t value) noexcept {
+  return (std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63);
+}
+inline std::int64_t unzigzag(const std::uint64_t value) noexcept {
+  return std::int64_t(value >> 1) ^ -std::int64_t(value & 1);
+}
+inline unsigned int width(const std::uint32_t value) noexcept {
+  if (value < (1u << 8))
+    return 1;
+  if (value < (1u << 16))
+    return 2;
+  return value < (1u << 24) ? 3 : 4;
+}
+inline unsigned int leb128(std::uint64_t value) noexcept {
+  unsigned int len{1};
+  while (value >= 0x80) {
+    value >>= 7;
+    len++;
+  }
+  return len;
+}
+
+inline std::size_t align(const std::size_t offset,
+                         const std::size_t alignment) noexcept {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+template <class T> std::size_t scalar_end(const std::size_t offset) noexcept {
+  return align(offset, sizeof(T)) + sizeof(T);
+}
+template <class T>
+std::size_t sequence_end(const std::size_t offset,
+                         const std::size_t n) noexcept {
+  return align(scalar_end<std::uint64_t>(offset), sizeof(T)) + n * sizeof(T);
+}
+
+template <class index_t>
+std::pair<std::size_t, std::size_t>
+slice_bounds(const std::vector<index_t> &indices, const index_t ib,
+             const index_t ie) {
+  const auto first =
+      std::lower_bound(std::begin(indices), std::end(indices), ib);
+  const auto last = std::lower_bound(first, std::end(indices), ie);
+  return {std::size_t(std::distance(std::begin(indices), first)),
+          std::size_t(std::distance(std::begin(indices), last))};
+}
+
+template <unsigned int bits = 2, class bit_t>
+void slice_codes(const std::vector<bit_t> &codes, const std::size_t first,
+                 const std::size_t last, std::vector<bit_t> &result) {
+  const std::size_t N = CHAR_BIT * sizeof(bit_t) / bits;
+  const bit_t mask = bit_t(~bit_t(0)) >> (CHAR_BIT * sizeof(bit_t) - bits);
+  const std::size_t n = (last - first + N - 1) / N;
+  if (first % N == 0) {
+    result.assign(std::begin(codes) + first / N,
+                  std::begin(codes) + first / N + n);
+    if (last % N != 0)
+      result.back() &= bit_t(~bit_t(0)) >>
+                       (CHAR_BIT * sizeof(bit_t) - bits * (last % N));
+    return;
+  }
+  result.assign(n, 0);
+  for (std::size_t k = first, newk = 0; k < last; k++, newk++) {
+    const bit_t val = (codes[k / N] >> (bits * (k % N))) & mask;
+    result[newk / N] |= bit_t(val << (bits * (newk % N)));
+  }
+}
+template <unsigned int bits = 2, class bit_t>
+std::vector<bit_t> slice_codes(const std::vector<bit_t> &codes,
+                               const std::size_t first,
+                               const std::size_t last) {
+  std::vector<bit_t> result;
+  slice_codes<bits>(codes, first, last, result);
+  return result;
+}
+
+// Packs 16 codes of the given width, each stored in its own byte, into
+// 2 * bits bytes, the first code in the lowest bits.
+inline void pack_codes(const std::uint8_t *lanes, std::uint8_t *out,
+                       std::integral_constant<unsigned int, 8>) {
+  std::memcpy(out, lanes, 16);
+}
+#ifdef __SSSE3__
+inline void pack_codes(const std::uint8_t *lanes, std::uint8_t *out,
+                       std::integral_constant<unsigned int, 4>) {
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes));
+  const __m128i pairs = _mm_maddubs_epi16(v, _mm_set1_epi16(0x1001));
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(out),
+                   _mm_packus_epi16(pairs, pairs));
+}
+inline void pack_codes(const std::uint8_t *lanes, std::uint8_t *out,
+                       std::integral_constant<unsigned int, 2>) {
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes));
+  const __m128i pairs = _mm_maddubs_epi16(v, _mm_set1_epi16(0x0401));
+  const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00100001));
+  const __m128i words = _mm_packs_epi32(quads, quads);
+  const std::int32_t packed =
+      _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+  std::memcpy(out, &packed, 4);
+}
+#else
+template <unsigned int bits>
+void pack_codes(const std::uint8_t *lanes, std::uint8_t *out,
+                std::integral_constant<unsigned int, bits>) {
+  constexpr unsigned int N = CHAR_BIT / bits;
+  for (unsigned int b = 0; b < 2 * bits; b++) {
+    std::uint8_t packed{0};
+    for (unsigned int lane = 0; lane < N; lane++)
+      packed |= std::uint8_t(lanes[N * b + lane] << (bits * lane));
+    out[b] = packed;
+  }
+}
+#endif
+template <unsigned int bits>
+void pack_codes(const std::uint8_t *lanes, std::uint8_t *out) {
+  pack_codes(lanes, out, std::integral_constant<unsigned int, bits>{});
+}
+
+#ifdef __SSSE3__
+struct shuffles {
+  shuffles() {
+    for (unsigned int c = 0; c < 256; c++) {
+      std::uint8_t offset{0};
+      for (unsigned int lane = 0; lane < 4; lane++) {
+        const unsigned int len = ((c >> (2 * lane)) & 3) + 1;
+        for (unsigned int b = 0; b < 4; b++)
+          masks[c][4 * lane + b] = b < len ? offset + b : 0x80;
+        offset += len;
+      }
+      lengths[c] = offset;
+    }
+  }
+  static const shuffles &get() {
+    static const shuffles table;
+    return table;
+  }
+
+  std::array<std::array<std::uint8_t, 16>, 256> masks;
+  std::array<std::uint8_t, 256> lengths;
+};
+#endif
+
+template <class index_t> struct packed_indices {
+  enum format_t : std::uint8_t { stream = 0, varint = 1, bitmap = 2 };
+
+  packed_indices() = default;
+  explicit packed_indices(const std::vector<index_t> &indices)
+      : count(indices.size()) {
+    const plan p = choose(indices);
+    format = p.format;
+    bytes = std::vector<std::uint8_t>(p.bytes);
+    if (format == bitmap)
+      encode_bitmap(indices);
+    else if (format == stream)
+      encode_stream(indices);
+    else
+      encode_varint(indices);
+  }
+
+  static std::size_t size(const std::vector<index_t> &indices,
+                          const std::size_t offset = 0) {
+    const std::size_t header = scalar_end<std::int64_t>(
+        scalar_end<std::uint64_t>(scalar_end<std::uint8_t>(offset)));
+    return sequence_end<std::uint8_t>(header, choose(indices).bytes);
+  }
+
+  // The fields come off the wire, so they are checked against each other
+  // before anything is decoded; malformed input throws std::range_error.
+  template <class OutputIt> OutputIt decode(OutputIt out) const {
+    validate();
+    return unpack(out);
+  }
+  std::vector<index_t> decode() const {
+    std::vector<index_t> indices;
+    decode_into(indices);
+    return indices;
+  }
+  void decode_into(std::vector<index_t> &indices) const {
+    validate();
+    indices.resize(count);
+    unpack(indices.data());
+  }
+
+  template <class Archive> void serialize(Archive &archive) {
+    archive(format, count, base, bytes);
+  }
+
+private:
+  struct plan {
+    format_t format;
+    std::size_t bytes;
+  };
+
+  static plan choose(const std::vector<index_t> &indices) {
+    const std::size_t n = indices.size();
+    std::size_t sbytes{(n + 3) / 4}, vbytes{0};
+    bool narrow{true}, increasing{true};
+    std::int64_t prev{0};
+    for (std::size_t k = 0; k < n; k++) {
+      const std::int64_t idx = indices[k];
+      const std::uint64_t delta = zigzag(idx - prev);
+      if (k > 0 && idx <= prev)
+        increasing = false;
+      if (delta > 0xffffffffu)
+        narrow = false;
+      else
+        sbytes += width(std::uint32_t(delta));
+      vbytes += leb128(delta);
+      prev = idx;
+    }
+
+    plan p{narrow ? stream : varint, narrow ? sbytes : vbytes};
+    if (n > 0 && increasing) {
+      const std::uint64_t span =
+          std::uint64_t(std::int64_t(indices.back()) - indices.front());
+      if (span / 8 + 1 < p.bytes)
+        p = plan{bitmap, std::size_t(span / 8 + 1)};
+    }
+    return p;
+  }
+
+  void encode_bitmap(const std::vector<index_t> &indices) {
+    base = indices.front();
+    for (const index_t idx : indices) {
+      const std::uint64_t bit = std::uint64_t(std::int64_t(idx) - base);
+      bytes[bit / 8] |= std::uint8_t(1u << (bit % 8));
+    }
+  }
+  void encode_stream(const std::vector<index_t> &indices) {
+    std::uint8_t *control = bytes.data();
+    std::uint8_t *data = control + (count + 3) / 4;
+    std::int64_t prev{0};
+    std::size_t k{0};
+    for (const index_t idx : indices) {
+      const std::uint32_t delta = std::uint32_t(zigzag(idx - prev));
+      const unsigned int len = width(delta);
+      control[k / 4] |= std::uint8_t((len - 1) << (2 * (k % 4)));
+      for (unsigned int b = 0; b < len; b++)
+        *data++ = std::uint8_t(delta >> (8 * b));
+      prev = idx;
+      k++;
+    }
+  }
+  void encode_varint(const std::vector<index_t> &indices) {
+    std::uint8_t *data = bytes.data();
+    std::int64_t prev{0};
+    for (const index_t idx : indices) {
+      std::uint64_t delta = zigzag(idx - prev);
+      while (delta >= 0x80) {
+        *data++ = std::uint8_t(delta | 0x80);
+        delta >>= 7;
+      }
+      *data++ = std::uint8_t(delta);
+      prev = idx;
+    }
+  }
+
+  void validate() const {
+    const std::size_t n = bytes.size();
+    if (format == bitmap) {
+      std::uint64_t ones{0};
+      for (std::uint8_t byte : bytes)
+        for (; byte != 0; byte &= std::uint8_t(byte - 1))
+          ones++;
+      if (ones != count)
+        throw std::range_error("packed_indices: bitmap does not match count");
+    } else if (format == stream) {
+      if (count > 4 * std::uint64_t(n))
+        throw std::range_error("packed_indices: truncated control bytes");
+      const std::size_t nc = (count + 3) / 4;
+      std::size_t length{nc};
+      for (std::size_t k = 0; k < count; k++)
+        length += ((bytes[k / 4] >> (2 * (k % 4))) & 3) + 1;
+      if (length > n)
+        throw std::range_error("packed_indices: truncated stream");
+    } else if (format == varint) {
+      if (count > n)
+        throw std::range_error("packed_indices: truncated varints");
+    } else
+      throw std::range_error("packed_indices: unknown format");
+  }
+
+  template <class OutputIt> OutputIt unpack(OutputIt out) const {
+    if (format == bitmap)
+      return decode_bitmap(out);
+    else if (format == stream)
+      return decode_stream(out);
+    return decode_varint(out);
+  }
+
+  template <class OutputIt> OutputIt decode_bitmap(OutputIt out) const {
+    std::int64_t offset{base};
+    for (std::uint8_t byte : bytes) {
+      while (byte != 0) {
+        unsigned int bit{0};
+        while (((byte >> bit) & 1) == 0)
+          bit++;
+        *out++ = index_t(offset + bit);
+        byte &= std::uint8_t(byte - 1);
+      }
+      offset += 8;
+    }
+    return out;
+  }
+  template <class OutputIt> OutputIt decode_stream(OutputIt out) const {
+    const std::uint8_t *control = bytes.data();
+    const std::uint8_t *data = control + (count + 3) / 4;
+    const std::uint8_t *end = bytes.data() + bytes.size();
+    std::int64_t prev{0};
+    std::size_t k{0};
+#ifdef __SSSE3__
+    const shuffles &table = shuffles::get();
+    const __m128i one = _mm_set1_epi32(1);
+    std::int32_t deltas[4];
+    for (; k + 4 <= count && data + 16 <= end; k += 4) {
+      const std::uint8_t c = control[k / 4];
+      const __m128i mask = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(table.masks[c].data()));
+      const __m128i v = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), mask);
+      const __m128i z = _mm_xor_si128(
+          _mm_srli_epi32(v, 1),
+          _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, one)));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(deltas), z);
+      data += table.lengths[c];
+      for (const std::int32_t delta : deltas) {
+        prev += delta;
+        *out++ = index_t(prev);
+      }
+    }
+#endif
+    for (; k < count; k++) {
+      const unsigned int len = ((control[k / 4] >> (2 * (k % 4))) & 3) + 1;
+      std::uint32_t delta{0};
+#if !defined(__BYTE_ORDER__) || (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+      if (data + 4 <= end) {
+        std::memcpy(&delta, data, 4);
+        delta &= 0xffffffffu >> (8 * (4 - len));
+        data += len;
+      } else
+#endif
+        for (unsigned int b = 0; b < len; b++)
+          delta |= std::uint32_t(*data++) << (8 * b);
+      prev += unzigzag(delta);
+      *out++ = index_t(prev);
+    }
+    return out;
+  }
+  template <class OutputIt> OutputIt decode_varint(OutputIt out) const {
+    const std::uint8_t *data = bytes.data();
+    const std::uint8_t *end = data + bytes.size();
+    std::int64_t prev{0};
+    for (std::uint64_t k = 0; k < count; k++) {
+      std::uint64_t delta{0};
+      unsigned int shift{0};
+      std::uint8_t byte;
+      do {
+        if (data == end || shift >= 64)
+          throw std::range_error("packed_indices: unterminated varint");
+        byte = *data++;
+        delta |= std::uint64_t(byte & 0x7f) << shift;
+        shift += 7;
+      } while (byte & 0x80);
+      prev += unzigzag(delta);
+      *out++ = index_t(prev);
+    }
+    return out;
+  }
+
+  std::uint8_t format{stream};
+  std::uint64_t count{0};
+  std::int64_t base{0};
+  std::vector<std::uint8_t> bytes;
+};
+} // namespace detail
+} // namespace encoder
+} // namespace polo
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef POLO_ENCODER_QSGD_HPP_
+#define POLO_ENCODER_QSGD_HPP_
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "cereal/types/vector.hpp"
+#include "polo/encoder/indices.hpp"
+#include "polo/utility/random.hpp"
+
+namespace polo {
+namespace encoder {
+template <class value_t, class index_t, unsigned int bits = 4,
+          class generator_t = utility::random::xoshiro256ss>
+class qsgd {
+  static_assert(bits == 2 || bits == 4 || bits == 8,
+                "qsgd: bits must be 2, 4 or 8");
+  static_assert(generator_t::min() == 0 &&
+                    generator_t::max() ==
+                        std::numeric_limits<std::uint64_t>::max(),
+                "qsgd: generator must produce 64 random bits");
+
+  static constexpr unsigned int N = CHAR_BIT / bits;
+  static constexpr unsigned int mask = (1u << bits) - 1;
+  static constexpr unsigned int negative = 1u << (bits - 1);
+
+  struct result_t {
+    result_t() = default;
+    result_t(const std::uint32_t levels, const std::uint64_t bucket,
+             const std::uint64_t start, const std::int64_t offset,
+             const std::uint64_t count, std::vector<value_t> norms,
+             std::vector<index_t> nzind, std::vector<std::uint8_t> codes)
+        : levels(levels), bucket(bucket), start(start), offset(offset),
+          count(count), norms(std::move(norms)), nzind(std::move(nzind)),
+          codes(std::move(codes)) {}
+
+    size_t size() const noexcept {
+      std::size_t offset = detail::scalar_end<std::uint32_t>(0);
+      offset = detail::scalar_end<std::uint64_t>(offset);
+      offset = detail::scalar_end<std::uint64_t>(offset);
+      offset = detail::scalar_end<std::int64_t>(offset);
+      offset = detail::scalar_end<std::uint64_t>(offset);
+      offset = detail::sequence_end<value_t>(offset, norms.size());
+      offset = detail::packed_indices<index_t>::size(nzind, offset);
+      return detail::sequence_end<std::uint8_t>(offset, codes.size());
+    }
+
+    template <class Archive> void save(Archive &archive) const {
+      archive(levels, bucket, start, offset, count, norms,
+              detail::packed_indices<index_t>(nzind), codes);
+    }
+    template <class Archive> void load(Archive &archive) {
+      detail::packed_indices<index_t> indices;
+      archive(levels, bucket, start, offset, count, norms, indices, codes);
+      indices.decode_into(nzind);
+    }
+
+    result_t slice(const index_t ib, const index_t ie) const {
+      result_t result;
+      slice(ib, ie, result);
+      return result;
+    }
+    result_t &slice(const index_t ib, const index_t ie,
+                    result_t &result) const {
+      std::size_t first, last;
+      if (nzind.empty()) {
+        const std::int64_t n = count;
+        first = std::min(std::max(std::int64_t(ib) - offset, std::int64_t{0}),
+                         n);
+        last = std::min(
+            std::max(std::int64_t(ie) - offset, std::int64_t(first)), n);
+      } else {
+        const auto range = detail::slice_bounds(nzind, ib, ie);
+        first = range.first;
+        last = range.second;
+      }
+
+      result.levels = levels;
+      result.bucket = bucket;
+      result.start = bucket == 0 ? 0 : (start + first) % bucket;
+      result.offset = nzind.empty() ? offset + std::int64_t(first) : 0;
+      result.count = last - first;
+      result.norms.clear();
+      if (first < last)
+        result.norms.assign(std::begin(norms) + which(first),
+                            std::begin(norms) + which(last - 1) + 1);
+      result.nzind.clear();
+      if (!nzind.empty())
+        result.nzind.assign(std::begin(nzind) + first,
+                            std::begin(nzind) + last);
+      detail::slice_codes<bits>(codes, first, last, result.codes);
+      return result;
+    }
+
+    template <class OutputIt>
+    OutputIt operator()(OutputIt xb, OutputIt xe, const index_t ib = 0) const {
+      std::fill(xb, xe, 0);
+
+      std::array<value_t, mask + 1> table;
+      for (unsigned int code = 0; code <= mask; code++) {
+        const value_t level = value_t(code & (negative - 1)) / levels;
+        table[code] = (code & negative) ? -level : level;
+      }
+
+      std::size_t k{0};
+      while (k < count) {
+        const std::size_t ke =
+            bucket == 0 ? count
+                        : std::min<std::size_t>(
+                              count, k + bucket - (start + k) % bucket);
+        const value_t norm = norms[which(k)];
+        for (; k < ke; k++) {
+          const unsigned int code = (codes[k / N] >> (bits * (k % N))) & mask;
+          const std::int64_t idx = nzind.empty() ? offset + k : nzind[k];
+          *(xb + (idx - ib)) = norm * table[code];
+        }
+      }
+
+      return xe;
+    }
+
+  private:
+    friend class qsgd;
+
+    std::size_t which(const std::size_t k) const noexcept {
+      return bucket == 0 ? 0 : (start + k) / bucket;
+    }
+
+    std::uint32_t levels{1};
+    std::uint64_t bucket{0}, start{0};
+    std::int64_t offset{0};
+    std::uint64_t count{0};
+    std::vector<value_t> norms;
+    std::vector<index_t> nzind;
+    std::vector<std::uint8_t> codes;
+  };
+
+  std::uint32_t s;
+  index_t B;
+  mutable generator_t gen;
+  mutable std::vector<value_t> values;
+
+public:
+  using result_type = result_t;
+
+  qsgd(const std::uint32_t levels = negative - 1, const index_t bucket = 0,
+       generator_t gen = generator_t{})
+      : s{std::max<std::uint32_t>(
+            1, std::min<std::uint32_t>(levels, negative - 1))},
+        B{bucket}, gen(std::move(gen)) {}
+  qsgd(const qsgd &) = default;
+  qsgd &operator=(const qsgd &) = default;
+  qsgd(qsgd &&) = default;
+  qsgd &operator=(qsgd &&) = default;
+
+  qsgd split() { return qsgd(s, B, utility::random::split(gen)); }
+
+  std::uint32_t levels() const noexcept { return s; }
+  index_t bucket() const noexcept { return B; }
+
+  template <class RandomIt>
+  result_type operator()(RandomIt xb, RandomIt xe) const {
+    result_type result;
+    operator()(xb, xe, result);
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
+                         ForwardIt ie) const {
+    result_type result;
+    operator()(xb, xe, ib, ie, result);
+    return result;
+  }
+
+  template <class RandomIt>
+  result_type &operator()(RandomIt xb, RandomIt xe,
+                          result_type &result) const {
+    result.nzind.clear();
+    return encode(xb, std::distance(xb, xe), result);
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type &operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie,
+                          result_type &result) const {
+    result.nzind.assign(ib, ie);
+    values.clear();
+    for (const index_t idx : result.nzind)
+      values.push_back(*(xb + idx));
+    return encode(std::begin(values), values.size(), result);
+  }
+
+private:
+  template <class RandomIt>
+  result_type &encode(RandomIt vb, const std::size_t n,
+                      result_type &result) const {
+    const std::size_t width =
+        B > 0 ? std::size_t(B) : std::max<std::size_t>(n, 1);
+
+    std::vector<value_t> &norms = result.norms;
+    norms.resize((n + width - 1) / width);
+    for (std::size_t b = 0; b < norms.size(); b++) {
+      value_t norm{0};
+      for (auto it = vb + b * width, end = vb + std::min(n, (b + 1) * width);
+           it != end; ++it)
+        norm += value_t(*it) * value_t(*it);
+      norms[b] = std::sqrt(norm);
+    }
+
+    std::vector<std::uint8_t> &codes = result.codes;
+    codes.resize((n + N - 1) / N);
+    const value_t unit = std::ldexp(value_t(1), -32);
+    std::uint64_t random{0};
+    bool spare{false};
+    value_t scale{0};
+    std::size_t bend{0};
+    auto code = [&](const std::size_t k) -> std::uint8_t {
+      if (k == bend) {
+        const value_t norm = norms[k / width];
+        scale = norm > 0 ? s / norm : 0;
+        bend += width;
+      }
+      if (!spare)
+        random = gen();
+      const value_t u = value_t(std::uint32_t(random)) * unit;
+      random >>= 32;
+      spare = !spare;
+
+      const value_t val = *(vb + k);
+      const value_t r = std::abs(val) * scale;
+      std::uint32_t level = std::uint32_t(r);
+      level = std::min(level + (u < r - level), s);
+      return level == 0 ? 0 : std::uint8_t(level | (val < 0 ? negative : 0));
+    };
+
+    // Codes are computed 16 at a time into their own bytes and then packed
+    // together, which vectorizes; the tail is packed one code at a time.
+    std::array<std::uint8_t, 16> lanes;
+    std::size_t k{0};
+    for (; k + 16 <= n; k += 16) {
+      for (std::size_t lane = 0; lane < lanes.size(); lane++)
+        lanes[lane] = code(k + lane);
+      detail::pack_codes<bits>(lanes.data(), codes.data() + k / N);
+    }
+    for (; k < n; k++) {
+      if (k % N == 0)
+        codes[k / N] = 0;
+      codes[k / N] |= std::uint8_t(code(k) << (bits * (k % N)));
+    }
+
+    result.levels = s;
+    result.bucket = std::uint64_t(B);
+    result.start = 0;
+    result.offset = 0;
+    result.count = n;
+    return result;
+  }
+};
+} // namespace encoder
+} // namespace polo
+
+#endif
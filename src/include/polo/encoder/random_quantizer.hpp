@@ -10,6 +10,8 @@
 #include <vector>
 
 #include "cereal/types/vector.hpp"
+#include "polo/encoder/indices.hpp"
+#include "polo/utility/random.hpp"
 
 namespace polo {
 namespace encoder {
@@ -23,38 +25,26 @@ class random_quantizer {
         : norm(norm), nzind(std::move(nzind)), signs(std::move(signs)) {}
 
     size_t size() const noexcept {
-      return sizeof(value_t) + sizeof(index_t) * nzind.size() +
-             sizeof(bit_t) * signs.size();
+      const std::size_t offset = detail::packed_indices<index_t>::size(
+          nzind, detail::scalar_end<value_t>(0));
+      return detail::sequence_end<bit_t>(offset, signs.size());
     }
 
-    template <class Archive> void serialize(Archive &archive) {
-      archive(norm, nzind, signs);
+    template <class Archive> void save(Archive &archive) const {
+      archive(norm, detail::packed_indices<index_t>(nzind), signs);
+    }
+    template <class Archive> void load(Archive &archive) {
+      detail::packed_indices<index_t> indices;
+      archive(norm, indices, signs);
+      indices.decode_into(nzind);
     }
 
     result_t slice(const index_t ib, const index_t ie) const {
-      const size_t nbits = CHAR_BIT * sizeof(bit_t);
-      const size_t N = nbits / 2;
-
-      std::vector<index_t> newind;
-      std::vector<bit_t> newsigns;
-
-      if (!nzind.empty() && ib <= nzind.back()) {
-        index_t k{0}, newk{0};
-        for (const index_t idx : nzind) {
-          if ((idx >= ib) & (idx < ie)) {
-            newind.push_back(idx);
-            const int val = (signs[k / N] >> (2 * (k % N))) & 3;
-            if (newk % N == 0)
-              newsigns.push_back(0);
-            newsigns[newk / N] |= (val << (2 * (newk % N)));
-            newk++;
-          } else if (idx >= ie)
-            break;
-          k++;
-        }
-      }
-
-      return result_t(norm, std::move(newind), std::move(newsigns));
+      const auto range = detail::slice_bounds(nzind, ib, ie);
+      return result_t(norm,
+                      std::vector<index_t>(std::begin(nzind) + range.first,
+                                           std::begin(nzind) + range.second),
+                      detail::slice_codes(signs, range.first, range.second));
     }
 
     template <class OutputIt>
@@ -75,6 +65,8 @@ class random_quantizer {
     }
 
   private:
+    friend class random_quantizer;
+
     value_t norm;
     std::vector<index_t> nzind;
     std::vector<bit_t> signs;
@@ -87,17 +79,30 @@ public:
   using result_type = result_t;
 
   random_quantizer(generator_t gen = generator_t{}) : gen(std::move(gen)) {}
-  random_quantizer(const random_quantizer &rhs)
-      : gen(std::random_device{}()), dist(rhs.dist) {}
-  random_quantizer &operator=(const random_quantizer &rhs) {
-    gen = generator_t(std::random_device{}());
-    dist = rhs.dist;
-    return *this;
-  }
+  random_quantizer(const random_quantizer &) = default;
+  random_quantizer &operator=(const random_quantizer &) = default;
   random_quantizer(random_quantizer &&) = default;
   random_quantizer &operator=(random_quantizer &&) = default;
 
+  random_quantizer split() {
+    return random_quantizer(utility::random::split(gen));
+  }
+
   template <class RandomIt> result_type operator()(RandomIt xb, RandomIt xe) {
+    result_type result;
+    operator()(xb, xe, result);
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie) {
+    result_type result;
+    operator()(xb, xe, ib, ie, result);
+    return result;
+  }
+
+  template <class RandomIt>
+  result_type &operator()(RandomIt xb, RandomIt xe, result_type &result) {
     const size_t nbits = CHAR_BIT * sizeof(bit_t);
     const size_t N = nbits / 2;
 
@@ -106,8 +111,10 @@ public:
         [](const value_t norm, const value_t val) { return norm + val * val; });
     norm = std::sqrt(norm);
 
-    std::vector<index_t> nzind;
-    std::vector<bit_t> signs;
+    std::vector<index_t> &nzind = result.nzind;
+    std::vector<bit_t> &signs = result.signs;
+    nzind.clear();
+    signs.clear();
 
     index_t idx{0}, k{0};
     while (xb != xe) {
@@ -128,11 +135,13 @@ public:
       idx++;
     }
 
-    return result_type(norm, std::move(nzind), std::move(signs));
+    result.norm = norm;
+    return result;
   }
 
   template <class RandomIt, class ForwardIt>
-  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie) {
+  result_type &operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie,
+                          result_type &result) {
     const size_t nbits = CHAR_BIT * sizeof(bit_t);
     const size_t N = nbits / 2;
 
@@ -143,8 +152,10 @@ public:
                                    });
     norm = std::sqrt(norm);
 
-    std::vector<index_t> nzind;
-    std::vector<bit_t> signs;
+    std::vector<index_t> &nzind = result.nzind;
+    std::vector<bit_t> &signs = result.signs;
+    nzind.clear();
+    signs.clear();
 
     index_t k{0};
     while (ib != ie) {
@@ -164,7 +175,8 @@ public:
       }
     }
 
-    return result_type(norm, std::move(nzind), std::move(signs));
+    result.norm = norm;
+    return result;
   }
 };
 } // namespace encoder
@@ -7,6 +7,8 @@
 #include <vector>
 
 #include "cereal/types/vector.hpp"
+#include "polo/encoder/indices.hpp"
+#include "polo/utility/random.hpp"
 
 namespace polo {
 namespace encoder {
@@ -18,30 +20,32 @@ class random_sparsifier {
         : nzind(std::move(nzind)), nzval(std::move(nzval)) {}
 
     size_t size() const noexcept {
-      return sizeof(index_t) * nzind.size() + sizeof(value_t) * nzval.size();
+      return detail::sequence_end<value_t>(
+          detail::packed_indices<index_t>::size(nzind), nzval.size());
     }
 
-    template <class Archive> void serialize(Archive &archive) {
-      archive(nzind, nzval);
+    template <class Archive> void save(Archive &archive) const {
+      archive(detail::packed_indices<index_t>(nzind), nzval);
+    }
+    template <class Archive> void load(Archive &archive) {
+      detail::packed_indices<index_t> indices;
+      archive(indices, nzval);
+      indices.decode_into(nzind);
     }
 
     result_t slice(const index_t ib, const index_t ie) const {
-      std::vector<index_t> newind;
-      std::vector<value_t> newval;
-
-      if (!nzind.empty() && ib <= nzind.back()) {
-        index_t k{0};
-        for (const index_t idx : nzind) {
-          if ((idx >= ib) & (idx < ie)) {
-            newind.push_back(idx);
-            newval.push_back(nzval[k]);
-          } else if (idx >= ie)
-            break;
-          k++;
-        }
-      }
-
-      return result_t(std::move(newind), std::move(newval));
+      result_t result;
+      slice(ib, ie, result);
+      return result;
+    }
+    result_t &slice(const index_t ib, const index_t ie,
+                    result_t &result) const {
+      const auto range = detail::slice_bounds(nzind, ib, ie);
+      result.nzind.assign(std::begin(nzind) + range.first,
+                          std::begin(nzind) + range.second);
+      result.nzval.assign(std::begin(nzval) + range.first,
+                          std::begin(nzval) + range.second);
+      return result;
     }
 
     template <class OutputIt>
@@ -56,6 +60,8 @@ class random_sparsifier {
     }
 
   private:
+    friend class random_sparsifier;
+
     std::vector<index_t> nzind;
     std::vector<value_t> nzval;
   };
@@ -72,20 +78,34 @@ public:
       : random_sparsifier(std::vector<value_t>(d, val), std::move(gen)) {}
   random_sparsifier(std::vector<value_t> probs, generator_t gen = generator_t{})
       : probs(std::move(probs)), gen(std::move(gen)) {}
-  random_sparsifier(const random_sparsifier &rhs)
-      : probs(rhs.probs), gen(std::random_device{}()), dist(rhs.dist) {}
-  random_sparsifier &operator=(const random_sparsifier &rhs) {
-    probs = rhs.probs;
-    gen = generator_t(std::random_device{}());
-    dist = rhs.dist;
-    return *this;
-  }
+  random_sparsifier(const random_sparsifier &) = default;
+  random_sparsifier &operator=(const random_sparsifier &) = default;
   random_sparsifier(random_sparsifier &&) = default;
   random_sparsifier &operator=(random_sparsifier &&) = default;
 
+  random_sparsifier split() {
+    return random_sparsifier(probs, utility::random::split(gen));
+  }
+
   template <class RandomIt> result_type operator()(RandomIt xb, RandomIt xe) {
-    std::vector<index_t> nzind;
-    std::vector<value_t> nzval;
+    result_type result;
+    operator()(xb, xe, result);
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie) {
+    result_type result;
+    operator()(xb, xe, ib, ie, result);
+    return result;
+  }
+
+  template <class RandomIt>
+  result_type &operator()(RandomIt xb, RandomIt xe, result_type &result) {
+    std::vector<index_t> &nzind = result.nzind;
+    std::vector<value_t> &nzval = result.nzval;
+    nzind.clear();
+    nzval.clear();
     index_t idx{0};
     while (xb != xe) {
       const value_t val = *xb++;
@@ -97,13 +117,16 @@ public:
       }
       idx++;
     }
-    return result_type(std::move(nzind), std::move(nzval));
+    return result;
   }
 
   template <class RandomIt, class ForwardIt>
-  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie) {
-    std::vector<index_t> nzind;
-    std::vector<value_t> nzval;
+  result_type &operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie,
+                          result_type &result) {
+    std::vector<index_t> &nzind = result.nzind;
+    std::vector<value_t> &nzval = result.nzval;
+    nzind.clear();
+    nzval.clear();
     while (ib != ie) {
       const index_t idx = *ib++;
       const value_t val = *(xb + idx);
@@ -114,7 +137,7 @@ public:
         nzval.push_back(val / prob);
       }
     }
-    return result_type(std::move(nzind), std::move(nzval));
+    return result;
   }
 };
 } // namespace encoder
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "cereal/types/vector.hpp"
+#include "polo/encoder/indices.hpp"
 
 namespace polo {
 namespace encoder {
@@ -20,12 +21,18 @@ template <class value_t, class index_t, class bit_t = uint8_t> class ternary {
         : norm(norm), nzind(std::move(nzind)), signs(std::move(signs)) {}
 
     size_t size() const noexcept {
-      return sizeof(value_t) + sizeof(index_t) * nzind.size() +
-             sizeof(bit_t) * signs.size();
+      const std::size_t offset = detail::packed_indices<index_t>::size(
+          nzind, detail::scalar_end<value_t>(0));
+      return detail::sequence_end<bit_t>(offset, signs.size());
     }
 
-    template <class Archive> void serialize(Archive &archive) {
-      archive(norm, nzind, signs);
+    template <class Archive> void save(Archive &archive) const {
+      archive(norm, detail::packed_indices<index_t>(nzind), signs);
+    }
+    template <class Archive> void load(Archive &archive) {
+      detail::packed_indices<index_t> indices;
+      archive(norm, indices, signs);
+      indices.decode_into(nzind);
     }
 
     result_t slice(const index_t ib, const index_t ie) const {
@@ -46,19 +53,11 @@ template <class value_t, class index_t, class bit_t = uint8_t> class ternary {
           newsigns[newk / N] |= (val << (2 * (newk % N)));
           newk++;
         }
-      } else if (ib <= nzind.back()) {
-        for (const index_t idx : nzind) {
-          if ((idx >= ib) & (idx < ie)) {
-            newind.push_back(idx);
-            const int val = (signs[k / N] >> (2 * (k % N))) & 3;
-            if (newk % N == 0)
-              newsigns.push_back(0);
-            newsigns[newk / N] |= (val << (2 * (newk % N)));
-            newk++;
-          } else if (idx >= ie)
-            break;
-          k++;
-        }
+      } else {
+        const auto range = detail::slice_bounds(nzind, ib, ie);
+        newind = std::vector<index_t>(std::begin(nzind) + range.first,
+                                      std::begin(nzind) + range.second);
+        newsigns = detail::slice_codes(signs, range.first, range.second);
       }
 
       return result_t(norm, std::move(newind), std::move(newsigns));
@@ -89,6 +88,8 @@ template <class value_t, class index_t, class bit_t = uint8_t> class ternary {
     }
 
   private:
+    friend class ternary;
+
     value_t norm;
     std::vector<index_t> nzind;
     std::vector<bit_t> signs;
@@ -99,6 +100,22 @@ public:
 
   template <class RandomIt>
   result_type operator()(RandomIt xb, RandomIt xe) const {
+    result_type result;
+    operator()(xb, xe, result);
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
+                         ForwardIt ie) const {
+    result_type result;
+    operator()(xb, xe, ib, ie, result);
+    return result;
+  }
+
+  template <class RandomIt>
+  result_type &operator()(RandomIt xb, RandomIt xe,
+                          result_type &result) const {
     const size_t nbits = CHAR_BIT * sizeof(bit_t);
     const size_t N = nbits / 2;
     const size_t d = std::distance(xb, xe);
@@ -107,7 +124,9 @@ public:
 
     index_t k{0};
     value_t norm{0};
-    std::vector<bit_t> signs(remain == 0 ? split : split + 1, 0);
+    std::vector<bit_t> &signs = result.signs;
+    signs.assign(remain == 0 ? split : split + 1, 0);
+    result.nzind.clear();
 
     while (xb != xe) {
       const value_t val = *xb++;
@@ -117,13 +136,13 @@ public:
       k++;
     }
 
-    return result_type(std::sqrt(norm), std::vector<index_t>{},
-                       std::move(signs));
+    result.norm = std::sqrt(norm);
+    return result;
   }
 
   template <class RandomIt, class ForwardIt>
-  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
-                         ForwardIt ie) const {
+  result_type &operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie,
+                          result_type &result) const {
     const size_t nbits = CHAR_BIT * sizeof(bit_t);
     const size_t N = nbits / 2;
     const size_t d = std::distance(ib, ie);
@@ -132,8 +151,10 @@ public:
 
     index_t k{0};
     value_t norm{0};
-    std::vector<index_t> nzind;
-    std::vector<bit_t> signs(remain == 0 ? split : split + 1, 0);
+    std::vector<index_t> &nzind = result.nzind;
+    std::vector<bit_t> &signs = result.signs;
+    nzind.clear();
+    signs.assign(remain == 0 ? split : split + 1, 0);
 
     while (ib != ie) {
       const index_t idx = *ib++;
@@ -145,7 +166,8 @@ public:
       k++;
     }
 
-    return result_type(std::sqrt(norm), std::move(nzind), std::move(signs));
+    result.norm = std::sqrt(norm);
+    return result;
   }
 };
 } // namespace encoder
@@ -3,14 +3,22 @@
 
 #include <algorithm>
 #include <cmath>
-#include <queue>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "cereal/types/vector.hpp"
+#include "polo/encoder/indices.hpp"
+#include "polo/utility/random.hpp"
+#include "polo/utility/thread_pool.hpp"
 
 namespace polo {
 namespace encoder {
+enum class selection { heap, exact, sampled, chunked };
+
 template <class value_t, class index_t> class topk {
   struct result_t {
     result_t() = default;
@@ -18,30 +26,32 @@ template <class value_t, class index_t> class topk {
         : nzind(std::move(nzind)), nzval(std::move(nzval)) {}
 
     size_t size() const noexcept {
-      return sizeof(index_t) * nzind.size() + sizeof(value_t) * nzval.size();
+      return detail::sequence_end<value_t>(
+          detail::packed_indices<index_t>::size(nzind), nzval.size());
     }
 
-    template <class Archive> void serialize(Archive &archive) {
-      archive(nzind, nzval);
+    template <class Archive> void save(Archive &archive) const {
+      archive(detail::packed_indices<index_t>(nzind), nzval);
+    }
+    template <class Archive> void load(Archive &archive) {
+      detail::packed_indices<index_t> indices;
+      archive(indices, nzval);
+      indices.decode_into(nzind);
     }
 
     result_t slice(const index_t ib, const index_t ie) const {
-      std::vector<index_t> newind;
-      std::vector<value_t> newval;
-
-      if (!nzind.empty() && ib <= nzind.back()) {
-        index_t k{0};
-        for (const index_t idx : nzind) {
-          if ((idx >= ib) & (idx < ie)) {
-            newind.push_back(idx);
-            newval.push_back(nzval[k]);
-          } else if (idx >= ie)
-            break;
-          k++;
-        }
-      }
-
-      return result_t(std::move(newind), std::move(newval));
+      result_t result;
+      slice(ib, ie, result);
+      return result;
+    }
+    result_t &slice(const index_t ib, const index_t ie,
+                    result_t &result) const {
+      const auto range = detail::slice_bounds(nzind, ib, ie);
+      result.nzind.assign(std::begin(nzind) + range.first,
+                          std::begin(nzind) + range.second);
+      result.nzval.assign(std::begin(nzval) + range.first,
+                          std::begin(nzval) + range.second);
+      return result;
     }
 
     template <class OutputIt>
@@ -56,91 +66,279 @@ template <class value_t, class index_t> class topk {
     }
 
   private:
+    friend class topk;
+
     std::vector<index_t> nzind;
     std::vector<value_t> nzval;
   };
 
+  struct workspace {
+    std::vector<value_t> values;
+    std::vector<index_t> indices;
+  };
+
   index_t K;
+  selection method;
+  std::size_t nsamples{0};
+  unsigned int nthreads{0};
+  utility::random::xoshiro256ss gen;
+  std::vector<index_t> block, merged;
+  workspace work;
+  std::vector<utility::random::xoshiro256ss> gens;
+  std::vector<workspace> locals;
+  std::vector<std::vector<index_t>> candidates;
+  std::unique_ptr<utility::thread_pool> pool;
 
 public:
   using result_type = result_t;
 
-  topk(const index_t K) : K{K} {}
+  topk(const index_t K, const selection method = selection::heap)
+      : K{K}, method{method} {}
+  topk(const topk &rhs)
+      : K{rhs.K}, method{rhs.method}, nsamples{rhs.nsamples},
+        nthreads{rhs.nthreads}, gen(rhs.gen) {}
+  topk &operator=(const topk &rhs) {
+    K = rhs.K;
+    method = rhs.method;
+    nsamples = rhs.nsamples;
+    nthreads = rhs.nthreads;
+    gen = rhs.gen;
+    return *this;
+  }
+  topk(topk &&) = default;
+  topk &operator=(topk &&) = default;
+
+  topk split() {
+    topk child(*this);
+    child.gen = utility::random::split(gen);
+    return child;
+  }
+
+  void samples(const std::size_t n) noexcept { nsamples = n; }
+  void threads(const unsigned int n) noexcept { nthreads = n; }
+
+  template <class RandomIt> result_type operator()(RandomIt xb, RandomIt xe) {
+    result_type result;
+    operator()(xb, xe, result);
+    return result;
+  }
+
+  template <class RandomIt, class ForwardIt>
+  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
+                         ForwardIt ie) {
+    result_type result;
+    operator()(xb, xe, ib, ie, result);
+    return result;
+  }
 
   template <class RandomIt>
-  result_type operator()(RandomIt xb, RandomIt xe) const {
-    const auto cmp = [xb](const index_t left, const index_t right) {
-      return std::abs(*(xb + left)) > std::abs(*(xb + right));
-    };
-    std::priority_queue<index_t, std::vector<index_t>, decltype(cmp)> heap(cmp);
+  result_type &operator()(RandomIt xb, RandomIt xe, result_type &result) {
+    std::vector<index_t> &nzind = result.nzind;
+    select(
+        std::distance(xb, xe),
+        [xb](const std::size_t pos) { return std::abs(*(xb + pos)); }, nzind);
 
+    result.nzval.resize(nzind.size());
     index_t k{0};
-    RandomIt xtemp{xb};
-    while (xtemp != xe) {
-      const value_t val = *xtemp++;
-      if (heap.size() < size_t(K))
-        heap.push(k);
-      else if (std::abs(val) > std::abs(*(xb + heap.top()))) {
-        heap.pop();
-        heap.push(k);
-      }
-      k++;
-    }
+    for (const index_t idx : nzind)
+      result.nzval[k++] = *(xb + idx);
 
-    const size_t len = heap.size();
-    std::vector<index_t> nzind(len);
-    std::vector<value_t> nzval(len);
+    return result;
+  }
 
-    std::generate(std::begin(nzind), std::end(nzind), [&heap]() {
-      const index_t idx = heap.top();
-      heap.pop();
-      return idx;
-    });
-    std::sort(std::begin(nzind), std::end(nzind));
+  template <class RandomIt, class ForwardIt>
+  result_type &operator()(RandomIt xb, RandomIt xe, ForwardIt ib, ForwardIt ie,
+                          result_type &result) {
+    block.assign(ib, ie);
+    std::vector<index_t> &nzind = result.nzind;
+    select(
+        block.size(),
+        [&](const std::size_t pos) { return std::abs(*(xb + block[pos])); },
+        nzind);
+    for (index_t &idx : nzind)
+      idx = block[idx];
+    if (!std::is_sorted(std::begin(nzind), std::end(nzind)))
+      std::sort(std::begin(nzind), std::end(nzind));
 
-    k = 0;
+    result.nzval.resize(nzind.size());
+    index_t k{0};
     for (const index_t idx : nzind)
-      nzval[k++] = *(xb + idx);
+      result.nzval[k++] = *(xb + idx);
 
-    return result_type(std::move(nzind), std::move(nzval));
+    return result;
   }
 
-  template <class RandomIt, class ForwardIt>
-  result_type operator()(RandomIt xb, RandomIt xe, ForwardIt ib,
-                         ForwardIt ie) const {
-    const auto cmp = [xb](const index_t left, const index_t right) {
-      return std::abs(*(xb + left)) > std::abs(*(xb + right));
+private:
+  template <class Magnitude>
+  void select(const std::size_t n, Magnitude mag,
+              std::vector<index_t> &positions) {
+    const std::size_t k = std::min(n, std::size_t(std::max(K, index_t{0})));
+    positions.clear();
+    if (k == 0)
+      return;
+    switch (method) {
+    case selection::heap:
+      return heap(n, k, mag, positions);
+    case selection::sampled:
+      return sampled(n, k, mag, positions);
+    case selection::chunked:
+      return chunked(n, k, mag, positions);
+    default:
+      return exact(n, k, mag, gen, work, positions);
+    }
+  }
+
+  template <class Magnitude>
+  static void heap(const std::size_t n, const std::size_t k, Magnitude mag,
+                   std::vector<index_t> &positions) {
+    const auto cmp = [&mag](const index_t left, const index_t right) {
+      return mag(left) > mag(right);
     };
-    std::priority_queue<index_t, std::vector<index_t>, decltype(cmp)> heap(cmp);
-
-    ForwardIt itemp{ib};
-    while (itemp != ie) {
-      const index_t idx = *itemp++;
-      const value_t val = *(xb + idx);
-      if (heap.size() < size_t(K))
-        heap.push(idx);
-      else if (std::abs(val) > std::abs(*(xb + heap.top()))) {
-        heap.pop();
-        heap.push(idx);
+
+    positions.clear();
+    for (std::size_t pos = 0; pos < n; pos++) {
+      if (positions.size() < k) {
+        positions.push_back(index_t(pos));
+        std::push_heap(std::begin(positions), std::end(positions), cmp);
+      } else if (mag(pos) > mag(positions.front())) {
+        std::pop_heap(std::begin(positions), std::end(positions), cmp);
+        positions.back() = index_t(pos);
+        std::push_heap(std::begin(positions), std::end(positions), cmp);
       }
     }
+    std::sort(std::begin(positions), std::end(positions));
+  }
 
-    const size_t len = heap.size();
-    std::vector<index_t> nzind(len);
-    std::vector<value_t> nzval(len);
+  template <class Magnitude, class generator_t>
+  static void exact(const std::size_t n, const std::size_t k, Magnitude mag,
+                    generator_t &gen, workspace &ws,
+                    std::vector<index_t> &positions) {
+    if (k < 128)
+      return heap(n, k, mag, positions);
+    if (4 * k > n)
+      return threshold(n, k, mag, ws.values, positions);
 
-    std::generate(std::begin(nzind), std::end(nzind), [&heap]() {
-      const index_t idx = heap.top();
-      heap.pop();
-      return idx;
-    });
-    std::sort(std::begin(nzind), std::end(nzind));
+    const std::size_t s = 16 * n / k;
+    ws.values.resize(s);
+    std::uniform_int_distribution<std::size_t> dist(0, n - 1);
+    for (auto &val : ws.values)
+      val = mag(dist(gen));
+    std::nth_element(std::begin(ws.values), std::begin(ws.values) + (s - 32),
+                     std::end(ws.values));
+    const value_t tau = ws.values[s - 32];
 
-    index_t k{0};
-    for (const index_t idx : nzind)
-      nzval[k++] = *(xb + idx);
+    std::vector<index_t> &candidates = ws.indices;
+    candidates.clear();
+    candidates.reserve(3 * k);
+    for (std::size_t pos = 0; pos < n; pos++)
+      if (mag(pos) >= tau)
+        candidates.push_back(index_t(pos));
+    if (candidates.size() < k)
+      return threshold(n, k, mag, ws.values, positions);
+
+    threshold(
+        candidates.size(), k,
+        [&](const std::size_t pos) { return mag(candidates[pos]); },
+        ws.values, positions);
+    for (index_t &pos : positions)
+      pos = candidates[pos];
+  }
+
+  template <class Magnitude>
+  static void threshold(const std::size_t n, const std::size_t k,
+                        Magnitude mag, std::vector<value_t> &work,
+                        std::vector<index_t> &positions) {
+    work.resize(n);
+    for (std::size_t pos = 0; pos < n; pos++)
+      work[pos] = mag(pos);
+    std::nth_element(std::begin(work), std::begin(work) + (n - k),
+                     std::end(work));
+    const value_t tau = work[n - k];
+    std::size_t ties =
+        k - std::count_if(std::begin(work) + (n - k) + 1, std::end(work),
+                          [tau](const value_t val) { return val > tau; });
+
+    positions.clear();
+    positions.reserve(k);
+    for (std::size_t pos = 0; pos < n; pos++) {
+      const value_t val = mag(pos);
+      if (val > tau)
+        positions.push_back(index_t(pos));
+      else if (val == tau && ties > 0) {
+        positions.push_back(index_t(pos));
+        ties--;
+      }
+    }
+  }
+
+  template <class Magnitude>
+  void sampled(const std::size_t n, const std::size_t k, Magnitude mag,
+               std::vector<index_t> &positions) {
+    const std::size_t s =
+        nsamples > 0 ? std::min(n, nsamples)
+                     : std::min(n, std::max(std::size_t{4096}, 16 * n / k));
+    if (s == n || (nsamples == 0 && k < 128))
+      return exact(n, k, mag, gen, work, positions);
+
+    std::vector<value_t> &values = work.values;
+    values.resize(s);
+    std::uniform_int_distribution<std::size_t> dist(0, n - 1);
+    for (auto &val : values)
+      val = mag(dist(gen));
+    const std::size_t rank =
+        std::min(s - 1, s - std::size_t(std::ceil(double(s) * k / n)));
+    std::nth_element(std::begin(values), std::begin(values) + rank,
+                     std::end(values));
+    const value_t tau = values[rank];
+
+    positions.clear();
+    positions.reserve(k + k / 4);
+    for (std::size_t pos = 0; pos < n; pos++) {
+      const value_t val = mag(pos);
+      if (val > tau || (val == tau && tau > 0))
+        positions.push_back(index_t(pos));
+    }
+  }
+
+  template <class Magnitude>
+  void chunked(const std::size_t n, const std::size_t k, Magnitude mag,
+               std::vector<index_t> &positions) {
+    const std::size_t available =
+        nthreads > 0 ? nthreads : std::thread::hardware_concurrency();
+    const std::size_t T = std::max(
+        std::size_t{1},
+        std::min(available, n / std::max(k, std::size_t{1} << 16)));
+    if (T == 1)
+      return exact(n, k, mag, gen, work, positions);
+
+    if (!pool || pool->size() != T) {
+      pool.reset(new utility::thread_pool(T));
+      gens.clear();
+      for (std::size_t t = 0; t < T; t++)
+        gens.push_back(utility::random::split(gen));
+      locals.resize(T);
+      candidates.resize(T);
+    }
+    auto task = [&](const std::size_t t) {
+      const std::size_t begin = n * t / T, end = n * (t + 1) / T;
+      exact(
+          end - begin, std::min(k, end - begin),
+          [&](const std::size_t pos) { return mag(begin + pos); }, gens[t],
+          locals[t], candidates[t]);
+      for (index_t &pos : candidates[t])
+        pos = index_t(begin + pos);
+    };
+    pool->run(task);
 
-    return result_type(std::move(nzind), std::move(nzval));
+    merged.clear();
+    for (const auto &c : candidates)
+      merged.insert(std::end(merged), std::begin(c), std::end(c));
+    exact(
+        merged.size(), k,
+        [&](const std::size_t pos) { return mag(merged[pos]); }, gen, work,
+        positions);
+    for (index_t &pos : positions)
+      pos = merged[pos];
   }
 };
 } // namespace encoder
@@ -3,6 +3,7 @@
 
 #include "polo/execution/multithread.hpp"
 #include "polo/execution/paramserver.hpp"
+#include "polo/execution/ring.hpp"
 #include "polo/execution/serial.hpp"
 
 #endif
@@ -10,7 +10,9 @@
 #include <utility>
 #include <vector>
 
+#include "polo/encoder/encode.hpp"
 #include "polo/utility/atomic.hpp"
+#include "polo/utility/random.hpp"
 #include "polo/utility/sampler.hpp"
 
 namespace polo {
@@ -54,9 +56,10 @@ protected:
             class Encoder>
   void solve(Algorithm *alg, Loss &&loss, Logger &&logger,
              Terminator &&terminate, Encoder &&encoder) {
-    auto task = [&, alg, encoder](const index_t wid) {
+    const auto encoders = streams(encoder);
+    auto task = [&, alg](const index_t wid) {
       kernel(alg, wid, std::forward<Loss>(loss), std::forward<Logger>(logger),
-             std::forward<Terminator>(terminate), encoder);
+             std::forward<Terminator>(terminate), encoders[wid]);
     };
     run_in_parallel(task);
   }
@@ -66,10 +69,12 @@ protected:
   void solve(Algorithm *alg, Loss &&loss, Space s, Sampler &&sampler,
              const index_t num, Logger &&logger, Terminator &&terminate,
              Encoder &&encoder) {
-    auto task = [&, alg, s, sampler, num, encoder](const index_t wid) {
-      kernel(alg, wid, std::forward<Loss>(loss), s, sampler, num,
+    const auto samplers = streams(sampler);
+    const auto encoders = streams(encoder);
+    auto task = [&, alg, s, num](const index_t wid) {
+      kernel(alg, wid, std::forward<Loss>(loss), s, samplers[wid], num,
              std::forward<Logger>(logger), std::forward<Terminator>(terminate),
-             encoder);
+             encoders[wid]);
     };
     run_in_parallel(task);
   }
@@ -82,11 +87,15 @@ protected:
              utility::sampler::detail::coordinate_sampler_t s2,
              Sampler2 &&sampler2, const index_t num_coordinates,
              Logger &&logger, Terminator &&terminate, Encoder &&encoder) {
-    auto task = [&, alg, s1, sampler1, num_components, s2, sampler2,
-                 num_coordinates, encoder](const index_t wid) {
-      kernel(alg, wid, std::forward<Loss>(loss), s1, sampler1, num_components,
-             s2, sampler2, num_coordinates, std::forward<Logger>(logger),
-             std::forward<Terminator>(terminate), encoder);
+    const auto samplers1 = streams(sampler1);
+    const auto samplers2 = streams(sampler2);
+    const auto encoders = streams(encoder);
+    auto task = [&, alg, s1, num_components, s2,
+                 num_coordinates](const index_t wid) {
+      kernel(alg, wid, std::forward<Loss>(loss), s1, samplers1[wid],
+             num_components, s2, samplers2[wid], num_coordinates,
+             std::forward<Logger>(logger), std::forward<Terminator>(terminate),
+             encoders[wid]);
     };
     run_in_parallel(task);
   }
@@ -99,6 +108,17 @@ protected:
   ~multithread() = default;
 
 private:
+  // Gives every thread its own stream of a sampler or an encoder.
+  template <class T>
+  std::vector<typename std::decay<T>::type> streams(const T &source) const {
+    typename std::decay<T>::type parent(source);
+    std::vector<typename std::decay<T>::type> children;
+    children.reserve(nthreads);
+    for (unsigned int wid = 0; wid < nthreads; wid++)
+      children.push_back(utility::random::split(parent));
+    return children;
+  }
+
   template <class Task> void run_in_parallel(Task task) {
     std::vector<std::thread> workers(nthreads);
     index_t wid = 0;
@@ -124,11 +144,12 @@ private:
     const value_t *gb_c = gb;
     const value_t *ge_c = ge;
 
+    typename Encoder::result_type enc;
     for (;;) {
       const index_t klocal = k;
       read(xlocal, std::integral_constant<bool, consistent>{});
       flocal = std::forward<Loss>(loss)(xb_c, gb);
-      auto enc = encoder(gb_c, ge_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c);
       enc(gb, ge);
       if (!update(alg, wid, klocal, flocal, glocal,
                   std::forward<Terminator>(terminate),
@@ -162,12 +183,13 @@ private:
     const index_t *cb_c = cb;
     const index_t *ce_c = ce;
 
+    typename Encoder::result_type enc;
     for (;;) {
       const index_t klocal = k;
       read(xlocal, std::integral_constant<bool, consistent>{});
       sampler(cb, ce);
       flocal = std::forward<Loss>(loss)(xb_c, gb, cb_c, ce_c);
-      auto enc = encoder(gb_c, ge_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c);
       enc(gb, ge);
       if (!update(alg, wid, klocal, flocal, glocal,
                   std::forward<Terminator>(terminate),
@@ -201,12 +223,13 @@ private:
     const index_t *cb_c = cb;
     const index_t *ce_c = ce;
 
+    typename Encoder::result_type enc;
     for (;;) {
       const index_t klocal = k;
       read(xlocal, std::integral_constant<bool, consistent>{});
       flocal = std::forward<Loss>(loss)(xb_c, gb);
       sampler(cb, ce);
-      auto enc = encoder(gb_c, ge_c, cb_c, ce_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c, cb_c, ce_c);
       enc(gb, ge);
       if (!update(alg, wid, klocal, flocal, glocal,
                   std::forward<Terminator>(terminate),
@@ -248,13 +271,14 @@ private:
     const index_t *coorb_c = coorb;
     const index_t *coore_c = coore;
 
+    typename Encoder::result_type enc;
     for (;;) {
       const index_t klocal = k;
       read(xlocal, std::integral_constant<bool, consistent>{});
       sampler1(compb, compe);
       flocal = std::forward<Loss>(loss)(xb_c, gb, compb_c, compe_c);
       sampler2(coorb, coore);
-      auto enc = encoder(gb_c, ge_c, coorb_c, coore_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c, coorb_c, coore_c);
       enc(gb, ge);
       if (!update(alg, wid, klocal, flocal, glocal,
                   std::forward<Terminator>(terminate),
@@ -2,11 +2,13 @@
 #define POLO_EXECUTION_PARAMSERVER_HPP_
 
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <cstdint>
-#include <exception>
-#include <future>
+#include <deque>
 #include <iterator>
-#include <sstream>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <tuple>
@@ -14,14 +16,16 @@
 #include <utility>
 #include <vector>
 
-#include "cereal/archives/portable_binary.hpp"
-#include "cereal/types/vector.hpp"
-
 #ifdef POLO_WITH_CURL
 #include "polo/communicator/address.hpp"
 #endif
 
+#include "polo/communicator/wire.hpp"
 #include "polo/communicator/zmq.hpp"
+#include "polo/encoder/encode.hpp"
+#include "polo/encoder/indices.hpp"
+#include "polo/prox/none.hpp"
+#include "polo/utility/random.hpp"
 #include "polo/utility/sampler.hpp"
 
 namespace polo {
@@ -31,21 +35,115 @@ namespace detail {
 template <class T>
 void deserialize(communicator::zmq::message &msg, const std::size_t pid,
                  T &val) {
-  std::istringstream iss(std::ios_base::binary);
-  iss.str(msg.read(pid));
-  cereal::PortableBinaryInputArchive ar(iss);
+  communicator::wire::reader ar(msg.data(pid), msg.size(pid));
   ar(val);
 }
-template <class T> std::string serialize(const T &val) {
-  std::ostringstream oss(std::ios_base::binary);
-  {
-    cereal::PortableBinaryOutputArchive ar(oss);
-    ar(val);
+template <class T, class OutputIt>
+OutputIt deserialize_into(communicator::zmq::message &msg,
+                          const std::size_t pid, OutputIt out) {
+  communicator::wire::reader ar(msg.data(pid), msg.size(pid));
+  return ar.extract<T>(out);
+}
+// Reads exactly n values, as pushes from aggregators carry them.
+template <class T, class OutputIt>
+OutputIt deserialize_into(communicator::zmq::message &msg,
+                          const std::size_t pid, OutputIt out,
+                          const std::size_t n) {
+  communicator::wire::reader ar(msg.data(pid), msg.size(pid));
+  std::uint64_t count;
+  ar(count);
+  if (count != n)
+    throw std::range_error("Expected " + std::to_string(n) + " values, got " +
+                           std::to_string(count));
+  return deserialize_into<T>(msg, pid, out);
+}
+template <class T> communicator::zmq::message::part serialize(const T &val) {
+  communicator::zmq::message::part part(communicator::wire::size(val));
+  communicator::wire::writer ar(part.data(), part.size());
+  ar(val);
+  return part;
+}
+
+// Thrown when masters do not reply in time. Workers then start over from a
+// fresh shard map, since masters may have come and gone; other failures,
+// such as rejected pushes, propagate.
+struct unanswered : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+// Thrown when the scheduler stops the run while a worker waits on masters.
+struct stopped {};
+
+// Endpoints of an address and port. Plain host names mean tcp, which binds
+// on every interface. Addresses that name their transport, such as
+// inproc://cluster or ipc:///tmp/cluster, get the port as a suffix instead.
+inline std::string endpoint(const std::string &address,
+                            const std::uint16_t port) {
+  const std::string suffix = ":" + std::to_string(port);
+  return address.find("://") == std::string::npos ? "tcp://" + address + suffix
+                                                  : address + suffix;
+}
+inline std::string bindpoint(const std::string &address,
+                             const std::uint16_t port) {
+  return address.find("://") == std::string::npos
+             ? "tcp://*:" + std::to_string(port)
+             : endpoint(address, port);
+}
+
+// Replaces the parts of a push from pid on with an empty part and the reason
+// it was rejected, so that the worker reports that instead of a lost reply.
+inline void reject(communicator::zmq::message &msg, const std::size_t pid,
+                   const std::string &reason) {
+  while (msg.numparts() > pid)
+    msg.pop_back();
+  msg.addpart();
+  msg.addpart(std::begin(reason), std::end(reason));
+}
+
+// Slices into a reused result when the encoder supports it, so that pushes to
+// many masters do not allocate a fresh result per shard.
+template <class Result, class index_t>
+auto slice(const Result &result, const index_t ib, const index_t ie,
+           Result &part, int) -> decltype(result.slice(ib, ie, part), void()) {
+  result.slice(ib, ie, part);
+}
+template <class Result, class index_t>
+void slice(const Result &result, const index_t ib, const index_t ie,
+           Result &part, long) {
+  part = result.slice(ib, ie);
+}
+
+// Columns of the sampled rows, for losses that expose their data matrix.
+// Other losses return false and workers pull whole shards.
+template <class Loss, class index_t>
+auto support(const Loss &loss, const index_t *ib, const index_t *ie,
+             std::vector<index_t> &coordinates, int)
+    -> decltype(loss.matrix()->colindices(*ib), bool()) {
+  const auto A = loss.matrix();
+  coordinates.clear();
+  for (; ib != ie; ++ib) {
+    const auto columns = A->colindices(*ib);
+    coordinates.insert(std::end(coordinates), std::begin(columns),
+                       std::end(columns));
   }
-  return oss.str();
+  std::sort(std::begin(coordinates), std::end(coordinates));
+  coordinates.erase(
+      std::unique(std::begin(coordinates), std::end(coordinates)),
+      std::end(coordinates));
+  return true;
+}
+template <class Loss, class index_t>
+bool support(const Loss &, const index_t *, const index_t *,
+             std::vector<index_t> &, long) {
+  return false;
 }
 } // namespace detail
 
+// How the scheduler splits x across masters. Except for contiguous, each
+// master owns a scattered set of coordinates, which workers map to and from
+// a contiguous range in the order the masters joined.
+enum struct layout { contiguous, strided, hashed, weighted };
+
 struct options {
   options() = default;
 
@@ -67,6 +165,67 @@ struct options {
     scheduler_timeout(timeout);
   }
 
+  void decentralized(const bool on) noexcept { decentralized_ = on; }
+  bool decentralized() const noexcept { return decentralized_; }
+
+  void gossip_interval(const long interval) noexcept { gossip_ = interval; }
+  long gossip_interval() const noexcept { return gossip_; }
+
+  void broadcast_interval(const std::int32_t updates) noexcept {
+    broadcast_ = updates;
+  }
+  std::int32_t broadcast_interval() const noexcept { return broadcast_; }
+
+  void aggregation_count(const std::int32_t count) noexcept {
+    acount_ = count;
+  }
+  std::int32_t aggregation_count() const noexcept { return acount_; }
+
+  void aggregation_time(const long time) noexcept { atime_ = time; }
+  long aggregation_time() const noexcept { return atime_; }
+
+  // Parallel decode only: pushed gradients are decoded on this many threads,
+  // but updates are applied one at a time, as the policies act on a master's
+  // whole slice. Pulls meanwhile see the last update that has finished.
+  void master_threads(const std::int32_t num) noexcept { mthreads_ = num; }
+  std::int32_t master_threads() const noexcept { return mthreads_; }
+
+  // Workers push to an aggregator bound at endpoint, which forwards the mean
+  // of every workers gradients to the masters as one push.
+  void aggregator(std::string endpoint, const std::int32_t workers) noexcept {
+    aendpoint_ = std::move(endpoint);
+    aworkers_ = workers;
+  }
+  std::pair<std::string, std::int32_t> aggregator() const noexcept {
+    return {aendpoint_, aworkers_};
+  }
+
+  void pipeline_depth(const std::int32_t depth) noexcept { depth_ = depth; }
+  std::int32_t pipeline_depth() const noexcept { return depth_; }
+
+  // Workers pull only the coordinates their sample touches. This needs the
+  // iterate they pull to serve one step, so it does not go with local steps,
+  // pipelining or broadcasts, which workers reject.
+  void sparse_pulls(const bool on) noexcept { sparse_ = on; }
+  bool sparse_pulls() const noexcept { return sparse_; }
+
+  // Workers take this many steps from every pulled iterate and push the
+  // change, which masters average over each aggregation window, weighted by
+  // the workers behind each push. Model averaging thus wants an aggregation
+  // count equal to the number of workers; a count of 1 applies every change
+  // as it arrives.
+  void local_steps(const std::int32_t steps) noexcept { steps_ = steps; }
+  std::int32_t local_steps() const noexcept { return steps_; }
+
+  void partition(const layout strategy) noexcept { layout_ = strategy; }
+  void partition(std::vector<double> weights) noexcept {
+    layout_ = layout::weighted;
+    weights_ = std::move(weights);
+  }
+  std::pair<layout, std::vector<double>> partition() const {
+    return {layout_, weights_};
+  }
+
   void num_masters(const std::int32_t num) noexcept { num_masters_ = num; }
   std::int32_t num_masters() const noexcept { return num_masters_; }
 
@@ -98,13 +257,30 @@ struct options {
     return {maddress_, mworker_};
   }
 
+  // Roles that run in the same process and share a context can talk over
+  // inproc:// addresses, e.g. workers and their node-local aggregator.
+  void context(communicator::zmq::context ctx) noexcept {
+    ctx_ = std::move(ctx);
+  }
+  communicator::zmq::context context() const noexcept { return ctx_; }
+
 private:
   int linger_{1000};
   long mtimeout_{10000}, wtimeout_{-1}, stimeout_{-1};
+  bool decentralized_{false}, sparse_{false};
+  long gossip_{100};
+  std::int32_t depth_{1}, broadcast_{0}, mthreads_{1}, acount_{1};
+  std::int32_t steps_{1};
+  long atime_{-1};
+  std::string aendpoint_;
+  std::int32_t aworkers_{1};
+  layout layout_{layout::contiguous};
+  std::vector<double> weights_;
   std::int32_t num_masters_{1};
   std::string saddress_{"localhost"}, maddress_;
   std::uint16_t spub_{40000}, smaster_{40001}, sworker_{40002};
   std::uint16_t mworker_{40000};
+  communicator::zmq::context ctx_;
 };
 
 template <class value_t, class index_t> struct master {
@@ -119,6 +295,13 @@ protected:
   void parameters(options opts) {
     linger = opts.linger();
     timeout = opts.master_timeout();
+    decentralized = opts.decentralized();
+    gossip = opts.gossip_interval();
+    broadcast = opts.broadcast_interval();
+    nthreads = opts.master_threads();
+    window = opts.aggregation_count();
+    wtime = opts.aggregation_time();
+    local = opts.local_steps() > 1;
     auto scheduler = opts.scheduler();
     saddress = std::get<0>(scheduler);
     spub = std::get<1>(scheduler);
@@ -126,6 +309,11 @@ protected:
     auto m = opts.master();
     maddress = m.first;
     mworker = m.second;
+    request = communicator::zmq::socket{};
+    router = communicator::zmq::socket{};
+    subscription = communicator::zmq::socket{};
+    feed = communicator::zmq::socket{};
+    ctx = opts.context();
   }
 
   template <class InputIt> std::vector<value_t> initialize(InputIt, InputIt) {
@@ -133,13 +321,13 @@ protected:
         communicator::zmq::socket{ctx, communicator::zmq::socket_type::sub};
     subscription.set(communicator::zmq::socket_opt::subscribe, 'M');
     subscription.set(communicator::zmq::socket_opt::subscribe, 'A');
-    std::string address = "tcp://" + saddress + ":" + std::to_string(spub);
+    std::string address = detail::endpoint(saddress, spub);
     subscription.connect(address.c_str());
 
     request =
         communicator::zmq::socket{ctx, communicator::zmq::socket_type::req};
     request.set(communicator::zmq::socket_opt::linger, linger);
-    address = "tcp://" + saddress + ":" + std::to_string(smaster);
+    address = detail::endpoint(saddress, smaster);
     request.connect(address.c_str());
 
     router =
@@ -147,10 +335,12 @@ protected:
     router.set(communicator::zmq::socket_opt::linger, linger);
     while (true) {
       try {
-        address = "tcp://*:" + std::to_string(mworker);
+        address = detail::bindpoint(maddress, mworker);
         router.bind(address.c_str());
         break;
-      } catch (...) {
+      } catch (const communicator::zmq::error &e) {
+        if (e != EADDRINUSE)
+          throw;
         mworker++;
       }
     }
@@ -161,7 +351,26 @@ protected:
       address = "tcp://" + myip.get() + ":" + std::to_string(mworker);
 #endif
     } else
-      address = "tcp://" + maddress + ":" + std::to_string(mworker);
+      address = detail::endpoint(maddress, mworker);
+
+    if (broadcast > 0) {
+      feed =
+          communicator::zmq::socket{ctx, communicator::zmq::socket_type::pub};
+      std::uint16_t mfeed = mworker + 1;
+      while (true) {
+        try {
+          const std::string endpoint = detail::bindpoint(maddress, mfeed);
+          feed.bind(endpoint.c_str());
+          break;
+        } catch (const communicator::zmq::error &e) {
+          if (e != EADDRINUSE)
+            throw;
+          mfeed++;
+        }
+      }
+      fendpoint = address.substr(0, address.rfind(':') + 1) +
+                  std::to_string(mfeed);
+    }
 
     communicator::zmq::message msg;
     msg.addpart(std::begin(address), std::end(address));
@@ -170,18 +379,26 @@ protected:
     poll.additem(request, communicator::zmq::poll_event::pollin);
 
     if (poll.poll(timeout) == 0)
-      throw std::runtime_error(address + ": No response from " + saddress +
-                               ":" + std::to_string(smaster) + " for " +
+      throw std::runtime_error(address + ": No response from " +
+                               detail::endpoint(saddress, smaster) + " for " +
                                std::to_string(timeout) + " ms.");
 
     msg.receive(request);
     if (msg.size() == 0)
-      throw std::runtime_error(address + ": Empty message from " + saddress +
-                               ":" + std::to_string(smaster) + ".");
+      throw std::runtime_error(address + ": Empty message from " +
+                               detail::endpoint(saddress, smaster) + ".");
 
     detail::deserialize(msg, 0, startind);
     detail::deserialize(msg, 1, x);
     g = std::vector<value_t>(x.size());
+    if (window > 1)
+      gsum = std::vector<value_t>(x.size());
+    if (broadcast > 0) {
+      xpub = x;
+      dirty.assign(x.size(), false);
+    }
+    xsnap = x;
+    xdata = detail::serialize(xsnap);
 
     xb = x.data();
     xb_c = xb;
@@ -194,28 +411,106 @@ protected:
     poll.clear();
     poll.additem(subscription, communicator::zmq::poll_event::pollin);
     poll.additem(router, communicator::zmq::poll_event::pollin);
+    poll.additem(request, communicator::zmq::poll_event::pollin);
 
     return x;
   }
 
   template <class Algorithm, class Loss, class Logger, class Terminator,
             class Encoder>
-  void solve(Algorithm *alg, Loss &&loss, Logger &&logger,
-             Terminator &&terminate, Encoder &&) {
-    value_t fval;
-    index_t wid, kworker;
-    std::string data;
+  void solve(Algorithm *alg, Loss &&, Logger &&logger, Terminator &&,
+             Encoder &&) {
+    using result_type = typename std::decay<Encoder>::type::result_type;
     communicator::zmq::message msg;
+    result_type enc;
+
+    communicator::zmq::socket tasks, done;
+    std::vector<std::thread> pool;
+    // Masters that share a context need their own names for the pool.
+    const std::string id = std::to_string(std::uintptr_t(this));
+    const std::string tendpoint = "inproc://polo-master-tasks-" + id;
+    const std::string dendpoint = "inproc://polo-master-done-" + id;
+    if (nthreads > 1) {
+      tasks = communicator::zmq::socket{ctx,
+                                        communicator::zmq::socket_type::push};
+      tasks.bind(tendpoint.c_str());
+      done = communicator::zmq::socket{ctx,
+                                       communicator::zmq::socket_type::pull};
+      done.bind(dendpoint.c_str());
+      poll.additem(done, communicator::zmq::poll_event::pollin);
+
+      for (std::int32_t t = 0; t < nthreads; t++)
+        pool.emplace_back([&]() {
+          communicator::zmq::socket in(ctx,
+                                       communicator::zmq::socket_type::pull);
+          communicator::zmq::socket out(ctx,
+                                        communicator::zmq::socket_type::push);
+          in.connect(tendpoint.c_str());
+          out.connect(dendpoint.c_str());
+
+          communicator::zmq::message work;
+          result_type decoded;
+          std::vector<value_t> gradient(x.size());
+          while (true) {
+            work.receive(in);
+            if (work.size() == 0)
+              break;
+            apply(alg, std::forward<Logger>(logger), work, decoded,
+                  gradient.data());
+            work.send(out);
+          }
+        });
+    }
 
-    typename std::decay<Encoder>::type::result_type enc;
+    // Set when there is bookkeeping left for once sync is free, which the
+    // pool may hold for a whole update; the loop then polls again shortly.
+    bool behind{false};
+    while (true) {
+      long wait{1};
+      {
+        std::unique_lock<std::mutex> lock(sync, std::try_to_lock);
+        behind = behind || !lock;
+        if (!behind)
+          wait = waittime();
+      }
+
+      if (poll.poll(wait) == 0) {
+        if (!behind) {
+          std::lock_guard<std::mutex> lock(sync);
+          if (aggregated == 0)
+            break;
+          flush(alg, std::forward<Logger>(logger));
+        }
+        behind = !progress();
+        continue;
+      }
 
-    while (poll.poll(timeout) > 0) {
       if (poll[0].isready()) {
         msg.receive(subscription);
         if (msg.size(1) == 1 && msg.read<char>(1) == 'T')
           break;
 
-        detail::deserialize(msg, 1, k);
+        index_t kscheduler;
+        detail::deserialize(msg, 1, kscheduler);
+        knotice = std::max(knotice, kscheduler);
+        behind = true;
+      }
+
+      if (poll[2].isready()) {
+        msg.receive(request);
+        reporting = false;
+        if (decentralized && msg.numparts() > 1) {
+          index_t kglobal;
+          detail::deserialize(msg, 1, kglobal);
+          knotice = std::max(knotice, kglobal);
+          behind = true;
+        }
+      }
+
+      if (poll.size() > 3 && poll[3].isready()) {
+        msg.receive(done);
+        msg.send(router);
+        behind = true;
       }
 
       if (poll[1].isready()) {
@@ -234,28 +529,50 @@ protected:
         const char tag = msg.read<char>(pid++);
 
         if (tag == 'x') {
-          data = detail::serialize(x);
-          msg[pid] = {std::begin(data), std::end(data)};
-          msg.send(router);
-        } else if (tag == 'g') {
-          detail::deserialize(msg, pid++, wid);
-          detail::deserialize(msg, pid++, kworker);
-          detail::deserialize(msg, pid++, fval);
-          detail::deserialize(msg, pid, enc);
-          enc(gb, ge, startind);
-          alg->boost(wid, kworker, k, gb_c, ge_c, gb);
-          alg->smooth(kworker, k, xb_c, xe_c, gb_c, gb);
-          const value_t step = alg->step(kworker, k, fval, xb_c, xe_c, gb_c);
-          alg->prox(step, xb_c, xe_c, gb_c, xb);
-          std::forward<Logger>(logger)(k, fval, xb_c, xe_c, gb_c);
-          msg.pop_back();
-          msg.pop_back();
-          msg.pop_back();
-          msg.pop_back();
-          msg.addpart();
+          refresh();
+          pulls++;
+          if (msg.size(pid) != 0)
+            msg[pid] = gather(msg, pid);
+          else
+            msg[pid] = xdata;
+          msg.addpart(detail::serialize(ksnap));
+          msg.addpart(detail::serialize(xversion));
+          if (broadcast > 0)
+            msg.addpart(std::begin(fendpoint), std::end(fendpoint));
           msg.send(router);
+        } else if (tag == 'g' || tag == 'a') {
+          if (nthreads > 1) {
+            msg.send(tasks);
+          } else {
+            apply(alg, std::forward<Logger>(logger), msg, enc, gb);
+            msg.send(router);
+            behind = true;
+          }
         }
       }
+
+      if (behind)
+        behind = !progress();
+    }
+
+    for (std::size_t t = 0; t < pool.size(); t++) {
+      msg.clear();
+      msg.addpart();
+      msg.send(tasks);
+    }
+    for (auto &thread : pool)
+      thread.join();
+    {
+      // Gradients of a partial window, including those the pool decoded
+      // after 'T', are applied rather than dropped.
+      std::lock_guard<std::mutex> lock(sync);
+      flush(alg, std::forward<Logger>(logger));
+    }
+    if (nthreads > 1) {
+      poll.clear();
+      poll.additem(subscription, communicator::zmq::poll_event::pollin);
+      poll.additem(router, communicator::zmq::poll_event::pollin);
+      poll.additem(request, communicator::zmq::poll_event::pollin);
     }
   }
 
@@ -286,18 +603,297 @@ protected:
   }
 
 private:
+  // Decoding runs concurrently on the pool; the policies are stateful and act
+  // on the whole slice, so the update itself is serialized.
+  template <class Algorithm, class Logger, class Result>
+  void apply(Algorithm *alg, Logger &&logger, communicator::zmq::message &msg,
+             Result &enc, value_t *gcurr) {
+    value_t fval;
+    index_t wid, kworker, tally, count{1};
+
+    std::size_t pid{0};
+    while (msg.size(pid) != 0)
+      pid++;
+    const char tag = msg.read<char>(++pid);
+    pid++;
+
+    const std::size_t first{pid};
+    try {
+      detail::deserialize(msg, pid++, wid);
+      detail::deserialize(msg, pid++, kworker);
+      detail::deserialize(msg, pid++, fval);
+      detail::deserialize(msg, pid++, tally);
+      if (tag == 'a') {
+        detail::deserialize(msg, pid++, count);
+        if (count < 1)
+          throw std::range_error("Expected a positive count, got " +
+                                 std::to_string(count));
+        detail::deserialize_into<value_t>(msg, pid, gcurr, x.size());
+      } else {
+        detail::deserialize(msg, pid, enc);
+        enc(gcurr, gcurr + x.size(), startind);
+      }
+    } catch (const std::range_error &e) {
+      detail::reject(msg, first, e.what());
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(sync);
+      pushes++;
+      received += msg.size(pid);
+      if (window <= 1) {
+        update(alg, std::forward<Logger>(logger), wid, kworker, fval, gcurr, 1,
+               tally);
+      } else {
+        // Changes from local steps are averaged over the workers behind
+        // them; gradients count once per push.
+        const index_t weight = local ? count : 1;
+        if (aggregated == 0) {
+          for (std::size_t idx = 0; idx < gsum.size(); idx++)
+            gsum[idx] = weight * gcurr[idx];
+          opened = std::chrono::steady_clock::now();
+          wsum = wid;
+          ksum = kworker;
+          fsum = weight * fval;
+          tsum = tally;
+        } else {
+          for (std::size_t idx = 0; idx < gsum.size(); idx++)
+            gsum[idx] += weight * gcurr[idx];
+          wsum = wid;
+          ksum = std::min(ksum, kworker);
+          fsum += weight * fval;
+          tsum += tally;
+        }
+        aggregated += weight;
+        if (aggregated >= window || expired())
+          flush(alg, std::forward<Logger>(logger));
+      }
+    }
+
+    while (msg.numparts() > first)
+      msg.pop_back();
+    msg.addpart();
+  }
+
+  // Callers hold sync.
+  template <class Algorithm, class Logger>
+  void update(Algorithm *alg, Logger &&logger, const index_t wid,
+              const index_t kworker, const value_t fval, value_t *gcurr,
+              const index_t ngradients, const index_t tally) {
+    const value_t *gcurr_c = gcurr, *gend_c = gcurr + x.size();
+    if (local) {
+      // Workers have already taken their steps, so their changes are only
+      // averaged in, over the workers behind them.
+      const value_t scale = value_t(1) / ngradients;
+      for (std::size_t idx = 0; idx < x.size(); idx++)
+        x[idx] -= scale * gcurr[idx];
+    } else {
+      alg->boost(wid, kworker, k, gcurr_c, gend_c, gcurr);
+      alg->smooth(kworker, k, xb_c, xe_c, gcurr_c, gcurr);
+      const value_t step = alg->step(kworker, k, fval, xb_c, xe_c, gcurr_c);
+      alg->prox(step, xb_c, xe_c, gcurr_c, xb);
+    }
+    if (broadcast > 0)
+      mark(gcurr_c, local || std::is_base_of<prox::none<value_t, index_t>,
+                                             Algorithm>::value);
+    std::forward<Logger>(logger)(k, fval, xb_c, xe_c, gcurr_c);
+    version++;
+    if (decentralized) {
+      k += tally;
+      counted += tally;
+    }
+  }
+
+  // Applies the gradients summed in the current window as one update, with
+  // the mean loss and the oldest iteration count among them. With local steps
+  // the sums are weighted, and aggregated holds the total weight. Callers
+  // hold sync.
+  template <class Algorithm, class Logger>
+  void flush(Algorithm *alg, Logger &&logger) {
+    if (aggregated == 0)
+      return;
+    update(alg, std::forward<Logger>(logger), wsum, ksum, fsum / aggregated,
+           gsum.data(), aggregated, tsum);
+    aggregated = 0;
+  }
+
+  // Values at the coordinates of a sparse pull, or nothing if any of them
+  // is outside this shard.
+  communicator::zmq::message::part gather(communicator::zmq::message &msg,
+                                         const std::size_t pid) {
+    encoder::detail::packed_indices<index_t> packed;
+    try {
+      detail::deserialize(msg, pid, packed);
+      packed.decode_into(requested);
+    } catch (const std::range_error &) {
+      return {};
+    }
+
+    values.clear();
+    for (const index_t idx : requested) {
+      if (idx < startind || idx - startind >= index_t(xsnap.size()))
+        return {};
+      values.push_back(xsnap[idx - startind]);
+    }
+    return detail::serialize(values);
+  }
+
+  bool expired() const {
+    return aggregated > 0 && wtime >= 0 &&
+           std::chrono::steady_clock::now() - opened >=
+               std::chrono::milliseconds(wtime);
+  }
+
+  long waittime() const {
+    if (aggregated == 0 || wtime < 0)
+      return timeout;
+    const long remaining = std::max<long>(
+        0, wtime - std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - opened)
+                       .count());
+    return timeout < 0 ? remaining : std::min(timeout, remaining);
+  }
+
+  // Returns false if an update holds sync, so that the caller tries again
+  // instead of waiting for it.
+  bool progress() {
+    std::unique_lock<std::mutex> lock(sync, std::try_to_lock);
+    if (!lock)
+      return false;
+    k = std::max(k, knotice);
+    if (broadcast > 0 && version - published >= std::uint64_t(broadcast))
+      publish();
+    report();
+    return true;
+  }
+
+  // Pulls are answered from a copy of x taken between two updates, so they
+  // never wait for one to finish. The copy is only taken when sync is free
+  // and only read by the thread that answers pulls.
+  void refresh() {
+    {
+      std::unique_lock<std::mutex> lock(sync, std::try_to_lock);
+      if (!lock)
+        return;
+      ksnap = k;
+      if (xversion == version)
+        return;
+      std::copy(std::begin(x), std::end(x), std::begin(xsnap));
+      xversion = version;
+    }
+    xdata = detail::serialize(xsnap);
+  }
+
+  // Sends the traffic served so far and, in decentralized mode, the number of
+  // pushes this master was the one to count. The scheduler sums those over
+  // masters and replies with the total.
+  void report() {
+    const auto now = std::chrono::steady_clock::now();
+    if (reporting || now - reported < std::chrono::milliseconds(gossip))
+      return;
+
+    communicator::zmq::message msg;
+    if (decentralized) {
+      msg.addpart('c');
+      msg.addpart(detail::serialize(counted));
+    } else
+      msg.addpart('l');
+    msg.addpart(detail::serialize(pulls));
+    msg.addpart(detail::serialize(pushes));
+    msg.addpart(detail::serialize(received));
+    try {
+      msg.send(request, false);
+    } catch (const communicator::zmq::error &e) {
+      // Over inproc, a scheduler that has closed leaves nothing to queue on.
+      if (e != EAGAIN)
+        throw;
+      return;
+    }
+    reporting = true;
+    reported = now;
+  }
+
+  // Without a proximal operator, an update moves exactly the coordinates
+  // where the final direction is nonzero. Any other prox may move the rest
+  // as well, so the next delta falls back to a full diff. Callers hold sync.
+  void mark(const value_t *gcurr, const bool separable) {
+    if (!separable) {
+      everything = true;
+      return;
+    }
+    if (everything)
+      return;
+    for (std::size_t idx = 0; idx < x.size(); idx++)
+      if (gcurr[idx] != 0 && !dirty[idx]) {
+        dirty[idx] = true;
+        touched.push_back(idx);
+      }
+  }
+
+  // Deltas carry the new values of the coordinates that changed between two
+  // versions, so applying one to any replica in that range catches it up.
+  void publish() {
+    changed.clear();
+    values.clear();
+    if (everything) {
+      touched.resize(x.size());
+      for (std::size_t idx = 0; idx < x.size(); idx++)
+        touched[idx] = idx;
+    } else
+      std::sort(std::begin(touched), std::end(touched));
+    for (const index_t idx : touched) {
+      if (x[idx] != xpub[idx]) {
+        changed.push_back(idx);
+        values.push_back(x[idx]);
+        xpub[idx] = x[idx];
+      }
+      dirty[idx] = false;
+    }
+    touched.clear();
+    everything = false;
+
+    communicator::zmq::message msg;
+    msg.addpart('X');
+    msg.addpart(detail::serialize(startind));
+    msg.addpart(detail::serialize(published));
+    msg.addpart(detail::serialize(version));
+    msg.addpart(detail::serialize(k));
+    msg.addpart(detail::serialize(changed));
+    msg.addpart(detail::serialize(values));
+    msg.send(feed);
+    published = version;
+  }
+
   int linger;
-  long timeout;
-  std::string maddress, saddress;
+  long timeout, gossip;
+  bool decentralized, reporting{false}, local{false}, everything{false};
+  std::int32_t broadcast{0}, nthreads{1}, window{1};
+  long wtime{-1};
+  std::chrono::steady_clock::time_point reported, opened;
+  std::string maddress, saddress, fendpoint;
   std::uint16_t spub, smaster, mworker;
-  index_t startind, k{1};
+  index_t startind, k{1}, counted{0}, aggregated{0}, wsum, ksum, tsum;
+  // Iteration counts from the scheduler and k at the time of the snapshot,
+  // both kept by the thread that polls.
+  index_t knotice{0}, ksnap{1};
+  value_t fsum;
+  std::uint64_t version{0}, published{0}, xversion{0};
+  std::uint64_t pulls{0}, pushes{0}, received{0};
   value_t *xb, *gb, *ge;
   const value_t *xb_c, *xe_c, *gb_c, *ge_c;
-  std::vector<value_t> x, g;
+  std::vector<value_t> x, g, gsum, xpub, xsnap, values;
+  std::vector<index_t> changed, requested, touched;
+  std::vector<bool> dirty;
+  // Serialized xsnap, which is x at xversion; copies share the buffer
+  // through zmq_msg_copy.
+  communicator::zmq::message::part xdata;
+  std::mutex sync;
   communicator::zmq::context ctx;
   communicator::zmq::socket request{ctx, communicator::zmq::socket_type::req},
       router{ctx, communicator::zmq::socket_type::router},
-      subscription{ctx, communicator::zmq::socket_type::sub};
+      subscription{ctx, communicator::zmq::socket_type::sub},
+      feed{ctx, communicator::zmq::socket_type::pub};
   communicator::zmq::poller poll;
 };
 
@@ -313,10 +909,26 @@ protected:
   void parameters(options opts) {
     linger = opts.linger();
     timeout = opts.worker_timeout();
+    decentralized = opts.decentralized();
+    depth = std::max<std::int32_t>(1, opts.pipeline_depth());
+    broadcast = opts.broadcast_interval() > 0;
+    steps = std::max<std::int32_t>(1, opts.local_steps());
+    sparse = opts.sparse_pulls();
+    if (sparse && (broadcast || depth > 1 || steps > 1))
+      throw std::domain_error("paramserver: sparse pulls do not go with local "
+                              "steps, pipelining or broadcasts");
+    aendpoint = opts.aggregator().first;
     auto scheduler = opts.scheduler();
     saddress = std::get<0>(scheduler);
     spub = std::get<1>(scheduler);
     sworker = std::get<3>(scheduler);
+    request = communicator::zmq::socket{};
+    subscription = communicator::zmq::socket{};
+    feed = communicator::zmq::socket{};
+    dealers.clear();
+    maddresses.clear();
+    replies.clear();
+    ctx = opts.context();
   }
 
   template <class InputIt>
@@ -334,13 +946,13 @@ protected:
         communicator::zmq::socket{ctx, communicator::zmq::socket_type::sub};
     subscription.set(communicator::zmq::socket_opt::subscribe, 'W');
     subscription.set(communicator::zmq::socket_opt::subscribe, 'A');
-    std::string address = "tcp://" + saddress + ":" + std::to_string(spub);
+    std::string address = detail::endpoint(saddress, spub);
     subscription.connect(address.c_str());
 
     request =
         communicator::zmq::socket{ctx, communicator::zmq::socket_type::req};
     request.set(communicator::zmq::socket_opt::linger, linger);
-    address = "tcp://" + saddress + ":" + std::to_string(sworker);
+    address = detail::endpoint(saddress, sworker);
     request.connect(address.c_str());
 
 #ifdef POLO_WITH_CURL
@@ -354,38 +966,43 @@ protected:
     poll.additem(request, communicator::zmq::poll_event::pollin);
 
     if (poll.poll(timeout) == 0)
-      throw std::runtime_error(address + ": No response from " + saddress +
-                               ":" + std::to_string(sworker) + " for " +
+      throw std::runtime_error(address + ": No response from " +
+                               detail::endpoint(saddress, sworker) + " for " +
                                std::to_string(timeout) + " ms.");
 
     msg.receive(request);
     if (msg.numparts() != 2 || msg.read<char>(0) != 'r')
-      throw std::runtime_error(address + ": Wrong message from " + saddress +
-                               ":" + std::to_string(sworker) + ".");
+      throw std::runtime_error(address + ": Wrong message from " +
+                               detail::endpoint(saddress, sworker) + ".");
 
     detail::deserialize(msg, 1, wid);
 
     poll.clear();
     poll.additem(subscription, communicator::zmq::poll_event::pollin);
     poll.additem(request, communicator::zmq::poll_event::pollin);
+    replies.additem(subscription, communicator::zmq::poll_event::pollin);
+
+    if (broadcast) {
+      feed =
+          communicator::zmq::socket{ctx, communicator::zmq::socket_type::sub};
+      feed.set(communicator::zmq::socket_opt::subscribe, 'X');
+      updates.additem(feed, communicator::zmq::poll_event::pollin);
+    }
 
     return x;
   }
 
   template <class Algorithm, class Loss, class Logger, class Terminator,
             class Encoder>
-  void solve(Algorithm *, Loss &&loss, Logger &&, Terminator &&,
+  void solve(Algorithm *alg, Loss &&loss, Logger &&, Terminator &&,
              Encoder &&encoder) {
-    auto f = [&]() {
-      fval = std::forward<Loss>(loss)(xb_c, gb);
-      return std::forward<Encoder>(encoder)(gb_c, ge_c);
-    };
-    kernel<typename std::decay<Encoder>::type>(f, nullptr);
+    auto f = [&]() { fval = std::forward<Loss>(loss)(xb_c, gb); };
+    kernel(alg, encoder, []() { return false; }, f, nullptr);
   }
 
   template <class Algorithm, class Loss, class Sampler, class Logger,
             class Terminator, class Encoder>
-  void solve(Algorithm *, Loss &&loss,
+  void solve(Algorithm *alg, Loss &&loss,
              utility::sampler::detail::component_sampler_t, Sampler &&sampler,
              const index_t num_components, Logger &&, Terminator &&,
              Encoder &&encoder) {
@@ -395,37 +1012,36 @@ protected:
     const index_t *cb_c = cb;
     const index_t *ce_c = ce;
 
-    auto f = [&, cb, ce, cb_c, ce_c]() {
+    auto prepare = [&, cb, ce, cb_c, ce_c]() {
       std::forward<Sampler>(sampler)(cb, ce);
+      return sparse && detail::support(loss, cb_c, ce_c, needed, 0);
+    };
+    auto f = [&, cb_c, ce_c]() {
       fval = std::forward<Loss>(loss)(xb_c, gb, cb_c, ce_c);
-      return std::forward<Encoder>(encoder)(gb_c, ge_c);
     };
-    kernel<typename std::decay<Encoder>::type>(f, nullptr);
+    kernel(alg, encoder, prepare, f, nullptr);
   }
 
   template <class Algorithm, class Loss, class Sampler, class Logger,
             class Terminator, class Encoder>
-  void solve(Algorithm *, Loss &&loss,
+  void solve(Algorithm *alg, Loss &&loss,
              utility::sampler::detail::coordinate_sampler_t, Sampler &&sampler,
              const index_t num_coordinates, Logger &&, Terminator &&,
              Encoder &&encoder) {
     std::vector<index_t> coordinates(num_coordinates);
     index_t *cb = coordinates.data();
     index_t *ce = cb + num_coordinates;
-    const index_t *cb_c = cb;
-    const index_t *ce_c = ce;
 
-    auto f = [&, cb, ce, cb_c, ce_c]() {
+    auto f = [&, cb, ce]() {
       fval = std::forward<Loss>(loss)(xb_c, gb);
       std::forward<Sampler>(sampler)(cb, ce);
-      return std::forward<Encoder>(encoder)(gb_c, ge_c, cb_c, ce_c);
     };
-    kernel<typename std::decay<Encoder>::type>(f, &coordinates);
+    kernel(alg, encoder, []() { return false; }, f, &coordinates);
   }
 
   template <class Algorithm, class Loss, class Sampler1, class Sampler2,
             class Logger, class Terminator, class Encoder>
-  void solve(Algorithm *, Loss &&loss,
+  void solve(Algorithm *alg, Loss &&loss,
              utility::sampler::detail::component_sampler_t, Sampler1 &&sampler1,
              const index_t num_components,
              utility::sampler::detail::coordinate_sampler_t,
@@ -440,17 +1056,16 @@ protected:
     std::vector<index_t> coordinates(num_coordinates);
     index_t *coorb = coordinates.data();
     index_t *coore = coorb + coordinates.size();
-    const index_t *coorb_c = coorb;
-    const index_t *coore_c = coore;
 
-    auto f = [&, compb, compe, compb_c, compe_c, coorb, coore, coorb_c,
-              coore_c]() {
+    auto prepare = [&, compb, compe, compb_c, compe_c]() {
       std::forward<Sampler1>(sampler1)(compb, compe);
+      return sparse && detail::support(loss, compb_c, compe_c, needed, 0);
+    };
+    auto f = [&, compb_c, compe_c, coorb, coore]() {
       fval = std::forward<Loss>(loss)(xb_c, gb, compb_c, compe_c);
       std::forward<Sampler2>(sampler2)(coorb, coore);
-      return std::forward<Encoder>(encoder)(gb_c, ge_c, coorb_c, coore_c);
     };
-    kernel<typename std::decay<Encoder>::type>(f, &coordinates);
+    kernel(alg, encoder, prepare, f, &coordinates);
   }
 
   value_t getf() const { return fval; }
@@ -461,192 +1076,894 @@ protected:
   ~worker() = default;
 
 private:
-  void askfor(const char tag, const std::vector<index_t> *indices) {
-    std::vector<index_t> range(2);
-    range[0] = indices == nullptr ? 0 : indices->front();
-    range[1] = indices == nullptr ? x.size() - 1 : indices->back();
-    auto data = detail::serialize(range);
-
+  bool askfor(const char tag) {
     msg.clear();
     msg.addpart(tag);
-    msg.addpart(std::begin(data), std::end(data));
-    msg.send(request);
+    return ask();
   }
 
-  void ack() {
-    msg.clear();
-    msg.addpart('u');
-    msg.send(request);
+  void cache() {
+    shards.clear();
+    for (std::size_t pid = 1; pid + 2 < msg.numparts(); pid += 3) {
+      shard s;
+      detail::deserialize(msg, pid, s.start);
+      detail::deserialize(msg, pid + 1, s.end);
+      s.dealer = connect(msg.read(pid + 2));
+      s.version = 0;
+      s.synced = false;
+      shards.push_back(s);
+    }
+
+    order.clear();
+    if (msg.numparts() % 3 == 2) {
+      detail::deserialize(msg, msg.numparts() - 1, order);
+      where.resize(order.size());
+      for (std::size_t pos = 0; pos < order.size(); pos++)
+        where[order[pos]] = pos;
+      xp.resize(x.size());
+      gp.resize(g.size());
+    }
   }
 
-  void ping() {
-    msg.clear();
-    msg.addpart();
-    msg.send(request);
+  // Encoders see the gradient in the masters' layout, so that slices line up
+  // with the shards whatever the partition.
+  template <class Encoder, class Result>
+  void encode(Encoder &encoder, Result &enc) {
+    if (order.empty()) {
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c);
+      return;
+    }
+    for (std::size_t pos = 0; pos < order.size(); pos++)
+      gp[pos] = g[order[pos]];
+    const value_t *gpb_c = gp.data(), *gpe_c = gpb_c + gp.size();
+    ::polo::encoder::encode(encoder, enc, gpb_c, gpe_c);
   }
 
-  void receive_x() {
-    index_t indstart{0}, indend;
-    std::vector<std::future<void>> futures;
+  template <class Encoder, class Result>
+  void encode(Encoder &encoder, Result &enc, const index_t *ib,
+              const index_t *ie) {
+    if (order.empty()) {
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c, ib, ie);
+      return;
+    }
+    positions.clear();
+    for (; ib != ie; ++ib) {
+      positions.push_back(where[*ib]);
+      gp[where[*ib]] = g[*ib];
+    }
+    std::sort(std::begin(positions), std::end(positions));
+    const value_t *gpb_c = gp.data(), *gpe_c = gpb_c + gp.size();
+    const index_t *pb_c = positions.data(), *pe_c = pb_c + positions.size();
+    ::polo::encoder::encode(encoder, enc, gpb_c, gpe_c, pb_c, pe_c);
+  }
 
-    detail::deserialize(msg, 1, k);
-    auto xstart = std::begin(x);
+  // Pulls and deltas land in the masters' layout, which is x itself unless
+  // the partition reorders coordinates.
+  value_t *target() { return order.empty() ? xb : xp.data(); }
 
-    for (std::size_t pid = 2; pid < msg.numparts(); pid += 2) {
-      detail::deserialize(msg, pid, indend);
+  void scatter(const value_t *source) {
+    for (std::size_t pos = 0; pos < order.size(); pos++)
+      xb[order[pos]] = source[pos];
+  }
 
-      std::promise<void> promise;
-      futures.push_back(promise.get_future());
+  bool ack() { return askfor('u'); }
 
-      std::thread(
-          [=](const std::string address, std::promise<void> promise) {
-            communicator::zmq::message msg;
-            msg.addpart('x');
-            msg.addpart();
+  bool ping() {
+    msg.clear();
+    msg.addpart();
+    return ask();
+  }
 
-            communicator::zmq::socket req(ctx,
-                                          communicator::zmq::socket_type::req);
-            req.set(communicator::zmq::socket_opt::linger, linger);
-            req.connect(address.c_str());
+  // Returns false when the scheduler has no connection left to take the
+  // request, as happens over inproc once it has closed.
+  bool ask() {
+    try {
+      msg.send(request, false);
+    } catch (const communicator::zmq::error &e) {
+      if (e != EAGAIN)
+        throw;
+      return false;
+    }
+    return true;
+  }
 
-            msg.send(req);
+  std::size_t connect(const std::string &address) {
+    const auto it =
+        std::find(std::begin(maddresses), std::end(maddresses), address);
+    if (it != std::end(maddresses))
+      return std::distance(std::begin(maddresses), it);
+
+    communicator::zmq::socket dealer(ctx,
+                                     communicator::zmq::socket_type::dealer);
+    dealer.set(communicator::zmq::socket_opt::linger, linger);
+    dealer.set(communicator::zmq::socket_opt::sndtimeo, int(timeout));
+    dealer.connect(address.c_str());
+    replies.additem(dealer, communicator::zmq::poll_event::pollin);
+    dealers.push_back(std::move(dealer));
+    maddresses.push_back(address);
+    return dealers.size() - 1;
+  }
 
-            communicator::zmq::poller poll;
-            poll.additem(req, communicator::zmq::poll_event::pollin);
-            if (poll.poll(timeout) > 0) {
-              msg.receive(req);
-              std::vector<value_t> values;
-              detail::deserialize(msg, 1, values);
-              std::copy(std::begin(values), std::end(values), xstart);
-              promise.set_value_at_thread_exit();
-            } else
-              promise.set_exception_at_thread_exit(std::make_exception_ptr(
-                  std::runtime_error("Could not get data")));
-          },
-          msg.read(pid + 1), std::move(promise))
-          .detach();
+  void reset() {
+    shards.clear();
+    rounds.clear();
+    pushes.clear();
+    prefetched = false;
+  }
 
-      xstart += indend - indstart;
-      indstart = indend;
+  // A dealer has nowhere to queue a request once its master has gone over
+  // inproc, so sends give up after timeout like replies do.
+  void send(communicator::zmq::message &outgoing, const std::size_t dealer) {
+    try {
+      outgoing.send(dealers[dealer]);
+    } catch (const communicator::zmq::error &e) {
+      if (e != EAGAIN)
+        throw;
+      throw detail::unanswered("Could not send data");
     }
+  }
+
+  // Requests carry a sequence number in front of the empty delimiter, which
+  // the masters echo back with the rest of the envelope.
+  std::uint32_t pull(value_t *buffer, const bool all = true) {
+    round r{++sequence, 'x', buffer, 0, {}, 0, {}};
+    communicator::zmq::message outgoing;
+    for (const auto &s : shards) {
+      if (!all && s.synced)
+        continue;
+
+      outgoing.clear();
+      outgoing.addpart(r.sequence);
+      outgoing.addpart();
+      outgoing.addpart('x');
+      outgoing.addpart();
+      send(outgoing, s.dealer);
+      r.pending.emplace_back(s.dealer, s.start);
+    }
+    r.remaining = r.pending.size();
+    rounds.push_back(std::move(r));
+    return sequence;
+  }
 
-    for (const auto &future : futures)
-      future.wait();
+  // Asks each master only for the coordinates in needed that it owns.
+  std::uint32_t pull(value_t *buffer, const std::vector<index_t> &needed) {
+    round r{++sequence, 'x', buffer, 0, {}, 0, needed};
+    if (!order.empty()) {
+      for (auto &idx : r.support)
+        idx = where[idx];
+      std::sort(std::begin(r.support), std::end(r.support));
+    }
 
-    for (auto &future : futures)
-      future.get();
+    communicator::zmq::message outgoing;
+    std::vector<index_t> owned;
+    for (const auto &s : shards) {
+      const auto first = std::lower_bound(std::begin(r.support),
+                                          std::end(r.support), s.start);
+      const auto last = std::lower_bound(first, std::end(r.support), s.end);
+      if (first == last)
+        continue;
+
+      owned.assign(first, last);
+      outgoing.clear();
+      outgoing.addpart(r.sequence);
+      outgoing.addpart();
+      outgoing.addpart('x');
+      outgoing.addpart(detail::serialize(
+          encoder::detail::packed_indices<index_t>(owned)));
+      send(outgoing, s.dealer);
+      r.pending.emplace_back(s.dealer, s.start);
+    }
+    r.remaining = r.pending.size();
+    rounds.push_back(std::move(r));
+    return sequence;
   }
 
-  template <class Encoder> void send(const Encoder &encoder) {
-    index_t indstart{0}, indend;
-    std::vector<std::future<void>> futures;
+  template <class Encoder>
+  std::uint32_t push(const Encoder &encoder, Encoder &part,
+                     const std::vector<index_t> *indices) {
+    round r{++sequence, 'g', nullptr, 0, {}, 0, {}};
+    if (indices != nullptr && !order.empty())
+      indices = &positions;
 
     const auto wdata = detail::serialize(wid);
     const auto kdata = detail::serialize(k);
     const auto fdata = detail::serialize(fval);
+    // Exactly one master counts each push towards the iteration count.
+    index_t tally{1};
+
+    communicator::zmq::message outgoing;
+    if (!aendpoint.empty()) {
+      const std::size_t m = connect(aendpoint);
+      outgoing.addpart(r.sequence);
+      outgoing.addpart();
+      outgoing.addpart('g');
+      outgoing.addpart(wdata);
+      outgoing.addpart(kdata);
+      outgoing.addpart(fdata);
+      outgoing.addpart(detail::serialize(tally));
+      outgoing.addpart(detail::serialize(encoder));
+      send(outgoing, m);
+      r.pending.emplace_back(m, 0);
+    }
+
+    for (const auto &s : shards) {
+      if (!aendpoint.empty() ||
+          (indices != nullptr &&
+           (s.end <= indices->front() || s.start > indices->back())))
+        continue;
+
+      outgoing.clear();
+      outgoing.addpart(r.sequence);
+      outgoing.addpart();
+      outgoing.addpart('g');
+      outgoing.addpart(wdata);
+      outgoing.addpart(kdata);
+      outgoing.addpart(fdata);
+      outgoing.addpart(detail::serialize(tally));
+      tally = 0;
+      detail::slice(encoder, s.start, s.end, part, 0);
+      outgoing.addpart(detail::serialize(part));
+      send(outgoing, s.dealer);
+      r.pending.emplace_back(s.dealer, s.start);
+    }
+    r.remaining = r.pending.size();
+    rounds.push_back(std::move(r));
+    return sequence;
+  }
+
+  void dispatch(const std::size_t dealer, communicator::zmq::message &reply) {
+    if (reply.numparts() < 3)
+      return;
+    const std::uint32_t seq = reply.read<std::uint32_t>(0);
+    for (auto &r : rounds) {
+      if (r.sequence != seq)
+        continue;
+      for (auto &entry : r.pending) {
+        if (entry.first != dealer)
+          continue;
+        if (r.tag == 'x') {
+          if (r.support.empty())
+            detail::deserialize_into<value_t>(reply, 3, r.xb + entry.second);
+          else
+            place(r.xb, r.support, entry.second, reply);
+          index_t kmaster{0};
+          if (reply.numparts() > 4)
+            detail::deserialize(reply, 4, kmaster);
+          r.k = std::max(r.k, kmaster);
+          if (reply.numparts() > 5)
+            synchronize(entry.second, reply);
+        } else if (reply.numparts() == 5 && reply.size(3) == 0)
+          throw std::runtime_error(maddresses[dealer] +
+                                   ": Push rejected: " + reply.read(4));
+        else if (reply.numparts() != 4 || reply.size(3) != 0)
+          throw std::range_error("Could not send data");
+        entry.first = dealers.size(); // answered
+        r.remaining--;
+        return;
+      }
+    }
+  }
+
+  // Writes the values of a sparse pull to the coordinates they were asked for
+  // in the shard starting at start.
+  void place(value_t *buffer, const std::vector<index_t> &support,
+             const index_t start, communicator::zmq::message &reply) {
+    values.clear();
+    detail::deserialize_into<value_t>(reply, 3, std::back_inserter(values));
+    for (const auto &s : shards) {
+      if (s.start != start)
+        continue;
+      const auto first =
+          std::lower_bound(std::begin(support), std::end(support), start);
+      const auto last = std::lower_bound(first, std::end(support), s.end);
+      if (std::distance(first, last) != std::ptrdiff_t(values.size()))
+        throw std::range_error("Could not get data");
+      for (std::size_t idx = 0; idx < values.size(); idx++)
+        buffer[first[idx]] = values[idx];
+      return;
+    }
+  }
 
-    for (std::size_t pid = 1; pid < msg.numparts(); pid += 2) {
-      detail::deserialize(msg, pid, indend);
+  void synchronize(const index_t start, communicator::zmq::message &reply) {
+    for (auto &s : shards) {
+      if (s.start != start)
+        continue;
+      detail::deserialize(reply, 5, s.version);
+      s.synced = true;
+    }
 
-      auto edata = detail::serialize(encoder.slice(indstart, indend));
+    if (!broadcast || reply.numparts() < 7)
+      return;
+    const std::string endpoint = reply.read(6);
+    if (std::find(std::begin(fendpoints), std::end(fendpoints), endpoint) ==
+        std::end(fendpoints)) {
+      feed.connect(endpoint.c_str());
+      fendpoints.push_back(endpoint);
+    }
+  }
 
-      std::promise<void> promise;
-      futures.push_back(promise.get_future());
+  // Applies the deltas the masters have published since the last iteration.
+  // A delta that starts past a shard's version means some were missed, and
+  // the shard is pulled again.
+  void drain() {
+    index_t start, kmaster;
+    std::uint64_t from, to;
+    while (updates.poll(0) > 0) {
+      update.receive(feed);
+      detail::deserialize(update, 1, start);
+      detail::deserialize(update, 2, from);
+      detail::deserialize(update, 3, to);
+      detail::deserialize(update, 4, kmaster);
+
+      for (auto &s : shards) {
+        if (s.start != start || !s.synced || to <= s.version)
+          continue;
+        if (from > s.version) {
+          s.synced = false;
+          continue;
+        }
+        detail::deserialize(update, 5, changed);
+        detail::deserialize(update, 6, values);
+        for (std::size_t idx = 0; idx < changed.size(); idx++)
+          target()[s.start + changed[idx]] = values[idx];
+        s.version = to;
+        k = std::max(k, kmaster);
+      }
+    }
+  }
 
-      std::thread(
-          [=](const std::string address, const std::string edata,
-              std::promise<void> promise) {
-            communicator::zmq::message msg;
-            msg.addpart('g');
-            msg.addpart(std::begin(wdata), std::end(wdata));
-            msg.addpart(std::begin(kdata), std::end(kdata));
-            msg.addpart(std::begin(fdata), std::end(fdata));
-            msg.addpart(std::begin(edata), std::end(edata));
+  void complete(const std::uint32_t seq) {
+    communicator::zmq::message reply;
+    while (true) {
+      auto r = std::find_if(
+          std::begin(rounds), std::end(rounds),
+          [=](const round &other) { return other.sequence == seq; });
+      if (r == std::end(rounds))
+        return;
+      if (r->remaining == 0) {
+        if (r->tag == 'x')
+          k = std::max(k, r->k);
+        rounds.erase(r);
+        return;
+      }
 
-            communicator::zmq::socket req(ctx,
-                                          communicator::zmq::socket_type::req);
-            req.set(communicator::zmq::socket_opt::linger, linger);
-            req.connect(address.c_str());
+      if (replies.poll(timeout) == 0)
+        throw detail::unanswered(r->tag == 'x' ? "Could not get data"
+                                               : "Could not send data");
+      if (replies[0].isready())
+        notice();
+      for (std::size_t idx = 0; idx < dealers.size(); idx++) {
+        if (!replies[idx + 1].isready())
+          continue;
+        reply.receive(dealers[idx]);
+        dispatch(idx, reply);
+      }
+    }
+  }
 
-            msg.send(req);
+  // Notices from the scheduler that arrive while masters are answering. A
+  // changed shard map is refetched once the iteration is over.
+  void notice() {
+    communicator::zmq::message msg;
+    msg.receive(subscription);
+    if (msg.size(1) != 1)
+      return;
+    if (msg.read<char>(1) == 'T')
+      throw detail::stopped{};
+    if (msg.read<char>(1) == 'D')
+      invalidated = true;
+  }
 
-            communicator::zmq::poller poll;
-            poll.additem(req, communicator::zmq::poll_event::pollin);
-            if (poll.poll(timeout) > 0) {
-              msg.receive(req);
-              if (msg.numparts() == 2 && msg.size(1) == 0)
-                promise.set_value_at_thread_exit();
-            } else
-              promise.set_exception_at_thread_exit(std::make_exception_ptr(
-                  std::runtime_error("Could not send data")));
-          },
-          msg.read(pid + 1), std::move(edata), std::move(promise))
-          .detach();
+  // With depth > 1, the next iterate is pulled into xnext while the current
+  // one is used, and up to depth - 1 pushes stay unacknowledged.
+  template <class Algorithm, class Encoder, class Prepare, class Function>
+  void iterate(Algorithm *alg, Encoder &encoder, Prepare &&prepare,
+               Function &&f, typename Encoder::result_type &enc,
+               typename Encoder::result_type &part,
+               const std::vector<index_t> *indices) {
+    if (std::forward<Prepare>(prepare)()) {
+      complete(pull(target(), needed));
+    } else if (broadcast) {
+      drain();
+      if (std::any_of(std::begin(shards), std::end(shards),
+                      [](const shard &s) { return !s.synced; }))
+        complete(pull(target(), false));
+    } else {
+      if (!prefetched)
+        xseq = pull(depth > 1 ? xnext.data() : target());
+      complete(xseq);
+      prefetched = false;
     }
 
-    for (const auto &future : futures)
-      future.wait();
+    if (!broadcast && depth > 1) {
+      if (order.empty()) {
+        std::swap(x, xnext);
+        xb = x.data();
+        xb_c = xb;
+      } else
+        scatter(xnext.data());
+      xseq = pull(xnext.data());
+      prefetched = true;
+    } else if (!order.empty())
+      scatter(xp.data());
+
+    if (steps > 1) {
+      descend(alg, std::forward<Prepare>(prepare), std::forward<Function>(f));
+      encode(encoder, enc);
+      indices = nullptr;
+    } else {
+      std::forward<Function>(f)();
+      if (indices == nullptr)
+        encode(encoder, enc);
+      else
+        encode(encoder, enc, indices->data(),
+               indices->data() + indices->size());
+    }
+    pushes.push_back(push(enc, part, indices));
+    while (pushes.size() >= depth) {
+      complete(pushes.front());
+      pushes.pop_front();
+    }
+  }
 
-    for (auto &future : futures)
-      future.get();
+  // Runs the local steps from the pulled iterate and leaves the change in g
+  // and x as it was pulled, so that deltas keep applying to it.
+  template <class Algorithm, class Prepare, class Function>
+  void descend(Algorithm *alg, Prepare &&prepare, Function &&f) {
+    xstart.assign(std::begin(x), std::end(x));
+    for (std::int32_t local = 0; local < steps; local++) {
+      if (local > 0)
+        std::forward<Prepare>(prepare)();
+      std::forward<Function>(f)();
+      alg->boost(wid, klocal, klocal, gb_c, ge_c, gb);
+      alg->smooth(klocal, klocal, xb_c, xb_c + x.size(), gb_c, gb);
+      const value_t gamma =
+          alg->step(klocal, klocal, fval, xb_c, xb_c + x.size(), gb_c);
+      alg->prox(gamma, xb_c, xb_c + x.size(), gb_c, xb);
+      klocal++;
+    }
+    for (std::size_t idx = 0; idx < x.size(); idx++)
+      g[idx] = xstart[idx] - x[idx];
+    std::copy(std::begin(xstart), std::end(xstart), std::begin(x));
   }
 
-  template <class Encoder, class Function>
-  void kernel(Function &&f, const std::vector<index_t> *indices) {
-    typename Encoder::result_type enc;
+  template <class Algorithm, class Encoder, class Prepare, class Function>
+  void kernel(Algorithm *alg, Encoder &encoder, Prepare &&prepare,
+              Function &&f, const std::vector<index_t> *indices) {
+    typename Encoder::result_type enc, part;
+    if (!broadcast && depth > 1)
+      xnext.resize(x.size());
 
-    askfor('x', nullptr);
+    askfor('d');
+    bool waiting{true};
+
+    while (true) {
+      const long wait = waiting ? timeout : 0;
+      if (poll.poll(wait) == 0 && waiting)
+        break;
 
-    while (poll.poll(timeout) > 0) {
       if (poll[0].isready()) {
         msg.receive(subscription);
         if (msg.size(1) == 1 && msg.read<char>(1) == 'T')
           break;
+        else if (msg.size(1) == 1 && msg.read<char>(1) == 'D')
+          reset();
       }
 
       if (poll[1].isready()) {
         msg.receive(request);
-        if (msg.size() == 0) {
-          askfor('x', nullptr);
-        } else {
-          const char tag = msg.read<char>(0);
-          if (tag == 'u')
-            askfor('x', nullptr);
-          else if (tag == 'x') {
-            try {
-              receive_x();
-              enc = std::forward<Function>(f)();
-              askfor('g', indices);
-            } catch (...) {
-              ping();
-            }
-          } else if (tag == 'g') {
-            try {
-              send(enc);
-              ack();
-            } catch (...) {
-              ping();
-            }
-          }
+        waiting = false;
+        if (msg.size() != 0 && msg.read<char>(0) == 'd')
+          cache();
+      }
+
+      if (waiting)
+        continue;
+
+      if (shards.empty()) {
+        if (!askfor('d'))
+          break;
+        waiting = true;
+        continue;
+      }
+
+      try {
+        iterate(alg, encoder, std::forward<Prepare>(prepare),
+                std::forward<Function>(f), enc, part, indices);
+        if (invalidated) {
+          reset();
+          invalidated = false;
+        }
+        if (!decentralized) {
+          if (!ack())
+            break;
+          waiting = true;
         }
+      } catch (const detail::stopped &) {
+        break;
+      } catch (const detail::unanswered &) {
+        reset();
+        if (!ping())
+          break;
+        waiting = true;
+      } catch (const std::range_error &) {
+        reset();
+        if (!ping())
+          break;
+        waiting = true;
       }
     }
   }
 
+  struct shard {
+    index_t start, end;
+    std::size_t dealer;
+    std::uint64_t version;
+    bool synced;
+  };
+
+  struct round {
+    std::uint32_t sequence;
+    char tag;
+    value_t *xb;
+    index_t k;
+    std::vector<std::pair<std::size_t, index_t>> pending;
+    std::size_t remaining;
+    // Coordinates of a sparse pull in the masters' layout; empty when
+    // whole shards are pulled.
+    std::vector<index_t> support;
+  };
+
   int linger;
   long timeout;
-  std::string saddress;
+  bool decentralized{false}, prefetched{false}, broadcast{false};
+  bool sparse{false}, invalidated{false};
+  std::size_t depth{1};
+  std::int32_t steps{1};
+  std::string saddress, aendpoint;
   std::uint16_t spub, sworker;
-  index_t wid, k;
+  index_t wid, k{0}, klocal{1};
   value_t fval;
   value_t *xb, *gb;
   const value_t *xb_c, *gb_c, *ge_c;
-  std::vector<value_t> x, g;
+  std::vector<value_t> x, xnext, xstart, g, values;
+  std::vector<index_t> changed;
+  // order maps positions in the masters' layout to coordinates of x and where
+  // is its inverse; xp and gp hold x and g in that layout.
+  std::vector<index_t> order, where, positions, needed;
+  std::vector<value_t> xp, gp;
   communicator::zmq::context ctx;
   communicator::zmq::socket request{ctx, communicator::zmq::socket_type::req},
-      subscription{ctx, communicator::zmq::socket_type::sub};
+      subscription{ctx, communicator::zmq::socket_type::sub},
+      feed{ctx, communicator::zmq::socket_type::sub};
+  communicator::zmq::poller poll, replies, updates;
+  communicator::zmq::message msg, update;
+  std::uint32_t sequence{0}, xseq{0};
+  std::vector<std::string> maddresses, fendpoints;
+  std::vector<communicator::zmq::socket> dealers;
+  std::vector<shard> shards;
+  std::deque<round> rounds;
+  std::deque<std::uint32_t> pushes;
+};
+
+template <class value_t, class index_t> struct aggregator {
+  aggregator() = default;
+
+  aggregator(const aggregator &) = default;
+  aggregator &operator=(const aggregator &) = default;
+  aggregator(aggregator &&) = default;
+  aggregator &operator=(aggregator &&) = default;
+
+protected:
+  void parameters(options opts) {
+    linger = opts.linger();
+    timeout = opts.worker_timeout();
+    wtime = opts.aggregation_time();
+    auto local = opts.aggregator();
+    endpoint = local.first;
+    nlocal = std::max<std::int32_t>(1, local.second);
+    auto scheduler = opts.scheduler();
+    saddress = std::get<0>(scheduler);
+    spub = std::get<1>(scheduler);
+    sworker = std::get<3>(scheduler);
+    request = communicator::zmq::socket{};
+    subscription = communicator::zmq::socket{};
+    router = communicator::zmq::socket{};
+    dealers.clear();
+    maddresses.clear();
+    ctx = opts.context();
+  }
+
+  template <class InputIt>
+  std::vector<value_t> initialize(InputIt xbegin, InputIt xend) {
+    std::vector<value_t> x(xbegin, xend);
+    g = std::vector<value_t>(x.size());
+    gsum = std::vector<value_t>(x.size());
+
+    subscription =
+        communicator::zmq::socket{ctx, communicator::zmq::socket_type::sub};
+    subscription.set(communicator::zmq::socket_opt::subscribe, 'W');
+    subscription.set(communicator::zmq::socket_opt::subscribe, 'A');
+    std::string address = detail::endpoint(saddress, spub);
+    subscription.connect(address.c_str());
+
+    request =
+        communicator::zmq::socket{ctx, communicator::zmq::socket_type::req};
+    request.set(communicator::zmq::socket_opt::linger, linger);
+    address = detail::endpoint(saddress, sworker);
+    request.connect(address.c_str());
+
+    router =
+        communicator::zmq::socket{ctx, communicator::zmq::socket_type::router};
+    router.set(communicator::zmq::socket_opt::linger, linger);
+    router.bind(endpoint.c_str());
+
+    msg.addpart('a');
+    msg.send(request);
+
+    poll.additem(request, communicator::zmq::poll_event::pollin);
+
+    if (poll.poll(timeout) == 0)
+      throw std::runtime_error(endpoint + ": No response from " +
+                               detail::endpoint(saddress, sworker) + " for " +
+                               std::to_string(timeout) + " ms.");
+
+    msg.receive(request);
+    if (msg.numparts() != 2 || msg.read<char>(0) != 'a')
+      throw std::runtime_error(endpoint + ": Wrong message from " +
+                               detail::endpoint(saddress, sworker) + ".");
+
+    detail::deserialize(msg, 1, wid);
+
+    poll.clear();
+    poll.additem(subscription, communicator::zmq::poll_event::pollin);
+    poll.additem(request, communicator::zmq::poll_event::pollin);
+    poll.additem(router, communicator::zmq::poll_event::pollin);
+
+    return x;
+  }
+
+  template <class Algorithm, class Loss, class Logger, class Terminator,
+            class Encoder>
+  void solve(Algorithm *, Loss &&, Logger &&, Terminator &&, Encoder &&) {
+    typename std::decay<Encoder>::type::result_type enc;
+    index_t wworker, kworker, tally;
+    value_t fval;
+
+    askfor('d');
+
+    while (true) {
+      if (poll.poll(waittime()) == 0) {
+        if (aggregated == 0 || shards.empty())
+          break;
+        forward();
+        continue;
+      }
+
+      if (poll[0].isready()) {
+        msg.receive(subscription);
+        if (msg.size(1) == 1 && msg.read<char>(1) == 'T') {
+          if (aggregated > 0 && !shards.empty())
+            forward();
+          break;
+        } else if (msg.size(1) == 1 && msg.read<char>(1) == 'D') {
+          // A map already asked for may predate the change, so it is asked
+          // for again once it arrives.
+          shards.clear();
+          if (asking)
+            stale = true;
+          else
+            askfor('d');
+        }
+      }
+
+      if (poll[1].isready()) {
+        msg.receive(request);
+        asking = false;
+        if (stale) {
+          stale = false;
+          askfor('d');
+        } else if (msg.size() != 0 && msg.read<char>(0) == 'd')
+          cache();
+      }
+
+      if (poll[2].isready()) {
+        msg.receive(router);
+
+        std::size_t pid{0};
+        while (msg.size(pid) != 0)
+          pid++;
+        pid++;
+
+        if (msg.size(pid) != 0 && msg.read<char>(pid) == 'g') {
+          try {
+            detail::deserialize(msg, pid + 1, wworker);
+            detail::deserialize(msg, pid + 2, kworker);
+            detail::deserialize(msg, pid + 3, fval);
+            detail::deserialize(msg, pid + 4, tally);
+            detail::deserialize(msg, pid + 5, enc);
+            accumulate(enc, kworker, fval);
+            while (msg.numparts() > pid + 1)
+              msg.pop_back();
+            msg.addpart();
+          } catch (const std::range_error &e) {
+            detail::reject(msg, pid + 1, e.what());
+          }
+        }
+        msg.send(router);
+
+        if (aggregated >= nlocal && !shards.empty())
+          forward();
+      }
+
+      for (std::size_t idx = 3; idx < poll.size(); idx++)
+        if (poll[idx].isready())
+          acknowledge(idx - 3);
+    }
+  }
+
+  template <class Algorithm, class Loss, class Space, class Sampler,
+            class Logger, class Terminator, class Encoder>
+  void solve(Algorithm *alg, Loss &&loss, Space, Sampler &&, const index_t,
+             Logger &&logger, Terminator &&terminate, Encoder &&encoder) {
+    solve(alg, std::forward<Loss>(loss), std::forward<Logger>(logger),
+          std::forward<Terminator>(terminate), std::forward<Encoder>(encoder));
+  }
+
+  template <class Algorithm, class Loss, class Sampler1, class Sampler2,
+            class Logger, class Terminator, class Encoder>
+  void solve(Algorithm *alg, Loss &&loss,
+             utility::sampler::detail::component_sampler_t, Sampler1 &&,
+             const index_t, utility::sampler::detail::coordinate_sampler_t,
+             Sampler2 &&, const index_t, Logger &&logger,
+             Terminator &&terminate, Encoder &&encoder) {
+    solve(alg, std::forward<Loss>(loss), std::forward<Logger>(logger),
+          std::forward<Terminator>(terminate), std::forward<Encoder>(encoder));
+  }
+
+  value_t getf() const { return 0; }
+  std::vector<value_t> getx() const { return {}; }
+
+  ~aggregator() = default;
+
+private:
+  void askfor(const char tag) {
+    msg.clear();
+    msg.addpart(tag);
+    msg.send(request);
+    asking = true;
+  }
+
+  void cache() {
+    shards.clear();
+    for (std::size_t pid = 1; pid + 2 < msg.numparts(); pid += 3) {
+      shard s;
+      detail::deserialize(msg, pid, s.start);
+      detail::deserialize(msg, pid + 1, s.end);
+      s.dealer = connect(msg.read(pid + 2));
+      shards.push_back(s);
+    }
+  }
+
+  std::size_t connect(const std::string &address) {
+    const auto it =
+        std::find(std::begin(maddresses), std::end(maddresses), address);
+    if (it != std::end(maddresses))
+      return std::distance(std::begin(maddresses), it);
+
+    communicator::zmq::socket dealer(ctx,
+                                     communicator::zmq::socket_type::dealer);
+    dealer.set(communicator::zmq::socket_opt::linger, linger);
+    dealer.set(communicator::zmq::socket_opt::sndtimeo, int(timeout));
+    dealer.connect(address.c_str());
+    poll.additem(dealer, communicator::zmq::poll_event::pollin);
+    dealers.push_back(std::move(dealer));
+    maddresses.push_back(address);
+    return dealers.size() - 1;
+  }
+
+  template <class Result>
+  void accumulate(const Result &enc, const index_t kworker,
+                  const value_t fval) {
+    enc(std::begin(g), std::end(g));
+    if (aggregated == 0) {
+      std::copy(std::begin(g), std::end(g), std::begin(gsum));
+      opened = std::chrono::steady_clock::now();
+      k = kworker;
+      fsum = fval;
+    } else {
+      for (std::size_t idx = 0; idx < gsum.size(); idx++)
+        gsum[idx] += g[idx];
+      k = std::min(k, kworker);
+      fsum += fval;
+    }
+    aggregated++;
+  }
+
+  // Sends the mean of the window to every master as one push of this node,
+  // with the number of gradients in it, which every master weighs the mean
+  // by and one of them also counts as iterations.
+  // The values go as they are rather than through the workers' encoder, which
+  // has already compressed them once. A master that does not take its part
+  // within timeout has gone, and its part is dropped as a lost push would be.
+  void forward() {
+    for (auto &val : gsum)
+      val /= aggregated;
+
+    const auto wdata = detail::serialize(wid);
+    const auto kdata = detail::serialize(k);
+    const auto fdata = detail::serialize(fsum / aggregated);
+    const auto cdata = detail::serialize(aggregated);
+    index_t tally{aggregated};
+
+    communicator::zmq::message outgoing;
+    for (const auto &s : shards) {
+      outgoing.clear();
+      outgoing.addpart();
+      outgoing.addpart('a');
+      outgoing.addpart(wdata);
+      outgoing.addpart(kdata);
+      outgoing.addpart(fdata);
+      outgoing.addpart(detail::serialize(tally));
+      tally = 0;
+      outgoing.addpart(cdata);
+      outgoing.addpart(detail::serialize(communicator::wire::make_span(
+          gsum.data() + s.start, gsum.data() + s.end)));
+      try {
+        outgoing.send(dealers[s.dealer]);
+      } catch (const communicator::zmq::error &e) {
+        if (e != EAGAIN)
+          throw;
+      }
+    }
+    aggregated = 0;
+  }
+
+  // Masters ack a push with an empty part and reject it with the reason
+  // after that.
+  void acknowledge(const std::size_t dealer) {
+    msg.receive(dealers[dealer]);
+    if (msg.numparts() == 4 && msg.size(2) == 0)
+      throw std::runtime_error(maddresses[dealer] +
+                               ": Push rejected: " + msg.read(3));
+    if (msg.numparts() != 3 || msg.size(2) != 0)
+      throw std::range_error(maddresses[dealer] + ": Wrong message.");
+  }
+
+  long waittime() const {
+    if (aggregated == 0 || wtime < 0)
+      return timeout;
+    const long remaining = std::max<long>(
+        0, wtime - std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - opened)
+                       .count());
+    return timeout < 0 ? remaining : std::min(timeout, remaining);
+  }
+
+  struct shard {
+    index_t start, end;
+    std::size_t dealer;
+  };
+
+  int linger;
+  long timeout, wtime{-1};
+  bool asking{false}, stale{false};
+  std::int32_t nlocal{1};
+  std::string saddress, endpoint;
+  std::uint16_t spub, sworker;
+  index_t wid, k, aggregated{0};
+  value_t fsum;
+  std::chrono::steady_clock::time_point opened;
+  std::vector<value_t> g, gsum;
+  communicator::zmq::context ctx;
+  communicator::zmq::socket request{ctx, communicator::zmq::socket_type::req},
+      subscription{ctx, communicator::zmq::socket_type::sub},
+      router{ctx, communicator::zmq::socket_type::router};
   communicator::zmq::poller poll;
   communicator::zmq::message msg;
+  std::vector<std::string> maddresses;
+  std::vector<communicator::zmq::socket> dealers;
+  std::vector<shard> shards;
 };
 
 template <class value_t, class index_t> struct scheduler {
@@ -657,43 +1974,60 @@ template <class value_t, class index_t> struct scheduler {
   scheduler(scheduler &&) = default;
   scheduler &operator=(scheduler &&) = default;
 
+  // Traffic each master has served as of its last report. start and end
+  // delimit its coordinates in the order of the partition.
+  struct load {
+    std::string address;
+    index_t start, end;
+    std::uint64_t pulls, pushes, bytes;
+  };
+  std::vector<load> loads() const { return stats; }
+
 protected:
   void parameters(options opts) {
     linger = opts.linger();
     timeout = opts.scheduler_timeout();
     nmasters = opts.num_masters();
+    auto layout = opts.partition();
+    strategy = layout.first;
+    weights = std::move(layout.second);
     auto scheduler = opts.scheduler();
+    saddress = std::get<0>(scheduler);
     ppub = std::get<1>(scheduler);
     pmaster = std::get<2>(scheduler);
     pworker = std::get<3>(scheduler);
+    publisher = communicator::zmq::socket{};
+    master = communicator::zmq::socket{};
+    worker = communicator::zmq::socket{};
+    ctx = opts.context();
   }
 
   template <class InputIt>
   std::vector<value_t> initialize(InputIt xbegin, InputIt xend) {
     const index_t d = std::distance(xbegin, xend);
-    const index_t split = d / nmasters;
-    const index_t remain = d % nmasters;
+    partition(d);
 
     index_t startind{0}, ndata;
     std::int32_t curmasters{0};
 
-    std::vector<value_t> x(xbegin, xend);
+    std::vector<value_t> x(xbegin, xend), values;
+    const value_t *xtemp = x.data();
 
     publisher =
         communicator::zmq::socket{ctx, communicator::zmq::socket_type::pub};
-    std::string endpoint = "tcp://*:" + std::to_string(ppub);
+    std::string endpoint = detail::bindpoint(saddress, ppub);
     publisher.bind(endpoint.c_str());
 
     master =
         communicator::zmq::socket{ctx, communicator::zmq::socket_type::router};
     master.set(communicator::zmq::socket_opt::linger, linger);
-    endpoint = "tcp://*:" + std::to_string(pmaster);
+    endpoint = detail::bindpoint(saddress, pmaster);
     master.bind(endpoint.c_str());
 
     worker =
         communicator::zmq::socket{ctx, communicator::zmq::socket_type::router};
     worker.set(communicator::zmq::socket_opt::linger, linger);
-    endpoint = "tcp://*:" + std::to_string(pworker);
+    endpoint = detail::bindpoint(saddress, pworker);
     worker.bind(endpoint.c_str());
 
     poll.additem(master, communicator::zmq::poll_event::pollin);
@@ -710,19 +2044,27 @@ protected:
       std::string address(msg.read(pid));
       msg.pop_back();
 
-      ndata = curmasters < remain ? split + 1 : split;
-      auto data = detail::serialize(startind);
-      msg.addpart(std::begin(data), std::end(data));
-
-      data = detail::serialize(std::vector<value_t>(xbegin, xbegin + ndata));
-      msg.addpart(std::begin(data), std::end(data));
+      ndata = sizes[curmasters];
+      msg.addpart(detail::serialize(startind));
+      if (order.empty())
+        msg.addpart(detail::serialize(
+            communicator::wire::make_span(xtemp, xtemp + ndata)));
+      else {
+        values.clear();
+        for (index_t pos = startind; pos < startind + ndata; pos++)
+          values.push_back(x[order[pos]]);
+        msg.addpart(detail::serialize(values));
+      }
 
+      identities.push_back(msg.read(0));
+      counts.push_back(0);
       msg.send(master);
 
+      stats.push_back(load{address, startind, startind + ndata, 0, 0, 0});
       datadist.emplace_back(std::make_pair(startind, startind + ndata),
                             std::move(address));
 
-      xbegin += ndata;
+      xtemp += ndata;
       startind += ndata;
       curmasters++;
     }
@@ -731,16 +2073,15 @@ protected:
                                " masters joined the network.");
 
     poll.additem(worker, communicator::zmq::poll_event::pollin);
+    invalidate();
 
     return x;
   }
 
   template <class Algorithm, class Loss, class Logger, class Terminator,
             class Encoder>
-  void solve(Algorithm *alg, Loss &&loss, Logger &&logger,
-             Terminator &&terminate, Encoder &&) {
-    std::string data;
-    std::vector<index_t> indices;
+  void solve(Algorithm *, Loss &&, Logger &&, Terminator &&terminate,
+             Encoder &&) {
     communicator::zmq::message msg;
 
     while (
@@ -761,42 +2102,50 @@ protected:
 
         const char tag = msg.read<char>(pid++);
 
-        if (tag == 'r') {
-          data = detail::serialize(wid++);
-          msg.addpart(std::begin(data), std::end(data));
+        if (tag == 'r' || tag == 'a') {
+          // Workers and aggregators draw ids from one counter, so that
+          // masters can tell every sender apart.
+          msg.addpart(detail::serialize(wid++));
+          msg.send(worker);
+        } else if (tag == 'd') {
+          for (const auto &pair : datadist) {
+            msg.addpart(paramserver::detail::serialize(pair.first.first));
+            msg.addpart(paramserver::detail::serialize(pair.first.second));
+            msg.addpart(std::begin(pair.second), std::end(pair.second));
+          }
+          if (!order.empty())
+            msg.addpart(paramserver::detail::serialize(order));
           msg.send(worker);
         } else if (tag == 'u') {
           k++;
           msg.send(worker);
           msg.clear();
           msg.addpart('M');
-          data = detail::serialize(k);
-          msg.addpart(std::begin(data), std::end(data));
+          msg.addpart(detail::serialize(k));
           msg.send(publisher);
-        } else if (tag == 'x' || tag == 'g') {
-          detail::deserialize(msg, pid, indices);
-          msg.pop_back();
-
-          if (tag == 'x') {
-            data = paramserver::detail::serialize(k);
-            msg.addpart(std::begin(data), std::end(data));
-          }
-
-          for (const auto &pair : datadist) {
-            if (pair.first.first <= indices[1] &&
-                pair.first.second > indices[0]) {
-              data = paramserver::detail::serialize(pair.first.second);
-              msg.addpart(std::begin(data), std::end(data));
-              msg.addpart(std::begin(pair.second), std::end(pair.second));
-            }
-          }
-
-          msg.send(worker);
         }
       }
 
       if (poll[0].isready()) {
-        // TODO: Implement handling of termination requests from masters
+        msg.receive(master);
+
+        std::size_t pid{0};
+        while (msg.size(pid) != 0)
+          pid++;
+        pid++;
+
+        if (msg.size(pid) != 0 && msg.read<char>(pid) == 'c') {
+          count(msg, pid + 1);
+          record(msg, pid + 2);
+          while (msg.numparts() > pid + 1)
+            msg.pop_back();
+          msg.addpart(detail::serialize(k));
+        } else if (msg.size(pid) != 0 && msg.read<char>(pid) == 'l') {
+          record(msg, pid + 1);
+          while (msg.numparts() > pid + 1)
+            msg.pop_back();
+        }
+        msg.send(master);
       }
     }
 
@@ -835,12 +2184,108 @@ protected:
   ~scheduler() = default;
 
 private:
+  // Lays the masters' coordinates out one master after another, sorted within
+  // each master, and leaves order empty when that is the identity.
+  void partition(const index_t d) {
+    order.clear();
+    sizes.assign(nmasters, d / nmasters);
+    if (strategy == layout::contiguous) {
+      for (index_t m = 0; m < d % nmasters; m++)
+        sizes[m]++;
+      return;
+    }
+
+    std::vector<std::vector<index_t>> owned(nmasters);
+    if (strategy == layout::weighted) {
+      if (weights.size() != std::size_t(d))
+        throw std::runtime_error("Scheduler: Expected " + std::to_string(d) +
+                                 " partition weights, got " +
+                                 std::to_string(weights.size()) + ".");
+
+      // Heaviest coordinates first, each to the master with the least weight
+      // so far, and the fewest coordinates among those.
+      std::vector<index_t> sorted(d);
+      for (index_t idx = 0; idx < d; idx++)
+        sorted[idx] = idx;
+      std::stable_sort(std::begin(sorted), std::end(sorted),
+                       [&](const index_t lhs, const index_t rhs) {
+                         return weights[lhs] > weights[rhs];
+                       });
+      std::vector<std::pair<double, std::size_t>> totals(nmasters);
+      for (const index_t idx : sorted) {
+        const auto m = std::distance(
+            std::begin(totals),
+            std::min_element(std::begin(totals), std::end(totals)));
+        owned[m].push_back(idx);
+        totals[m].first += weights[idx];
+        totals[m].second++;
+      }
+      for (auto &coordinates : owned)
+        std::sort(std::begin(coordinates), std::end(coordinates));
+    } else {
+      for (index_t idx = 0; idx < d; idx++) {
+        std::uint64_t state = idx;
+        const std::uint64_t key =
+            strategy == layout::strided
+                ? std::uint64_t(idx)
+                : utility::random::detail::splitmix64(state);
+        owned[key % nmasters].push_back(idx);
+      }
+    }
+
+    for (std::int32_t m = 0; m < nmasters; m++) {
+      sizes[m] = owned[m].size();
+      order.insert(std::end(order), std::begin(owned[m]), std::end(owned[m]));
+    }
+  }
+
+  // Masters count disjoint sets of pushes, so the iteration count in
+  // decentralized mode is the sum of their counts.
+  void count(communicator::zmq::message &msg, const std::size_t pid) {
+    const auto it =
+        std::find(std::begin(identities), std::end(identities), msg.read(0));
+    if (it == std::end(identities))
+      return;
+    paramserver::detail::deserialize(
+        msg, pid, counts[std::distance(std::begin(identities), it)]);
+    k = 1;
+    for (const index_t c : counts)
+      k += c;
+  }
+
+  void record(communicator::zmq::message &msg, const std::size_t pid) {
+    if (msg.numparts() < pid + 3)
+      return;
+    const auto it =
+        std::find(std::begin(identities), std::end(identities), msg.read(0));
+    if (it == std::end(identities))
+      return;
+    load &l = stats[std::distance(std::begin(identities), it)];
+    paramserver::detail::deserialize(msg, pid, l.pulls);
+    paramserver::detail::deserialize(msg, pid + 1, l.pushes);
+    paramserver::detail::deserialize(msg, pid + 2, l.bytes);
+  }
+
+  // Workers cache datadist and refetch it with 'd' after this notice.
+  void invalidate() {
+    communicator::zmq::message msg;
+    msg.addpart('W');
+    msg.addpart('D');
+    msg.send(publisher);
+  }
+
   int linger;
   long timeout;
   std::int32_t nmasters;
+  std::string saddress;
   std::uint16_t ppub, pmaster, pworker;
   index_t wid{0}, k{1};
+  layout strategy{layout::contiguous};
+  std::vector<double> weights;
+  std::vector<index_t> order, sizes, counts;
   std::vector<std::pair<std::pair<index_t, index_t>, std::string>> datadist;
+  std::vector<std::string> identities;
+  std::vector<load> stats;
   communicator::zmq::context ctx;
   communicator::zmq::socket publisher{ctx, communicator::zmq::socket_type::pub},
       master{ctx, communicator::zmq::socket_type::router},
@@ -854,6 +2299,9 @@ using executor = master<value_t, index_t>;
 #elif defined POLO_PARAMSERVER_WORKER
 template <class value_t, class index_t>
 using executor = worker<value_t, index_t>;
+#elif defined POLO_PARAMSERVER_AGGREGATOR
+template <class value_t, class index_t>
+using executor = aggregator<value_t, index_t>;
 #else
 template <class value_t, class index_t>
 using executor = scheduler<value_t, index_t>;
@@ -0,0 +1,379 @@
+#ifndef POLO_EXECUTION_RING_HPP_
+#define POLO_EXECUTION_RING_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "polo/communicator/wire.hpp"
+#include "polo/communicator/zmq.hpp"
+#include "polo/encoder/encode.hpp"
+#include "polo/encoder/identity.hpp"
+#include "polo/utility/sampler.hpp"
+
+namespace polo {
+namespace execution {
+namespace ring {
+namespace detail {
+template <class T>
+void deserialize(communicator::zmq::message &msg, const std::size_t pid,
+                 T &val) {
+  communicator::wire::reader ar(msg.data(pid), msg.size(pid));
+  ar(val);
+}
+template <class T, class OutputIt>
+OutputIt deserialize_into(communicator::zmq::message &msg,
+                          const std::size_t pid, OutputIt out) {
+  communicator::wire::reader ar(msg.data(pid), msg.size(pid));
+  return ar.extract<T>(out);
+}
+template <class T> communicator::zmq::message::part serialize(const T &val) {
+  communicator::zmq::message::part part(communicator::wire::size(val));
+  communicator::wire::writer ar(part.data(), part.size());
+  ar(val);
+  return part;
+}
+
+// The ring sums the values it passes around, so it only accepts encoders
+// whose results are the dense gradient itself.
+template <class value_t, class index_t, class Encoder>
+using dense = std::is_same<typename std::decay<Encoder>::type,
+                           encoder::identity<value_t, index_t>>;
+} // namespace detail
+
+struct options {
+  options() = default;
+
+  void linger(const int time) noexcept { linger_ = time; }
+  int linger() const noexcept { return linger_; }
+
+  void timeout(const long timeout) noexcept { timeout_ = timeout; }
+  long timeout() const noexcept { return timeout_; }
+
+  void peers(std::vector<std::string> endpoints) noexcept {
+    peers_ = std::move(endpoints);
+  }
+  std::vector<std::string> peers() const { return peers_; }
+
+  void rank(const std::int32_t rank) noexcept { rank_ = rank; }
+  std::int32_t rank() const noexcept { return rank_; }
+
+  void chunks(const std::int32_t num) noexcept { chunks_ = num; }
+  std::int32_t chunks() const noexcept { return chunks_; }
+
+  // Ranks that run as threads of one process can share a context and use
+  // inproc:// peers, which skip the network stack. Each rank has a context
+  // of its own otherwise.
+  void context(communicator::zmq::context ctx) noexcept {
+    ctx_ = std::move(ctx);
+  }
+  communicator::zmq::context context() const noexcept { return ctx_; }
+
+private:
+  int linger_{1000};
+  long timeout_{10000};
+  std::vector<std::string> peers_;
+  std::int32_t rank_{0}, chunks_{4};
+  communicator::zmq::context ctx_;
+};
+
+// Synchronous data-parallel execution: every rank holds a replica of x,
+// computes a gradient on its own data, and the gradients are averaged with a
+// ring allreduce before all ranks take the same step. Chunks are summed as
+// they travel, so gradients are exchanged dense and only the identity encoder
+// is accepted; with a coordinate sampler it zeroes the unsampled coordinates.
+template <class value_t, class index_t> struct allreduce {
+  allreduce() = default;
+
+  allreduce(const allreduce &) = default;
+  allreduce &operator=(const allreduce &) = default;
+  allreduce(allreduce &&) = default;
+  allreduce &operator=(allreduce &&) = default;
+
+protected:
+  void parameters(options opts) {
+    linger = opts.linger();
+    timeout = opts.timeout();
+    peers = opts.peers();
+    rank = opts.rank();
+    nchunks = std::max<std::int32_t>(1, opts.chunks());
+    left = communicator::zmq::socket{};
+    right = communicator::zmq::socket{};
+    ctx = opts.context();
+  }
+
+  template <class InputIt>
+  std::vector<value_t> initialize(InputIt xbegin, InputIt xend) {
+    k = 1;
+    fval = 0;
+    x = std::vector<value_t>(xbegin, xend);
+    g = std::vector<value_t>(x.size());
+    buffer = std::vector<value_t>(x.size() + 1);
+    xb = x.data();
+    xb_c = xb;
+    xe_c = xb_c + x.size();
+    gb = g.data();
+    ge = gb + g.size();
+    gb_c = gb;
+    ge_c = ge;
+
+    nranks = std::max<std::int32_t>(1, peers.size());
+    if (nranks > 1) {
+      if (rank < 0 || rank >= nranks)
+        throw std::runtime_error("Ring: rank " + std::to_string(rank) +
+                                 " is not in [0, " + std::to_string(nranks) +
+                                 ").");
+
+      const std::string &self = peers[rank];
+      const std::string endpoint =
+          self.compare(0, 6, "tcp://") == 0
+              ? "tcp://*:" + self.substr(self.rfind(':') + 1)
+              : self;
+      left = communicator::zmq::socket{ctx,
+                                       communicator::zmq::socket_type::pull};
+      left.set(communicator::zmq::socket_opt::linger, linger);
+      left.bind(endpoint.c_str());
+
+      right = communicator::zmq::socket{ctx,
+                                        communicator::zmq::socket_type::push};
+      right.set(communicator::zmq::socket_opt::linger, linger);
+      right.connect(peers[(rank + 1) % nranks].c_str());
+
+      poll.additem(left, communicator::zmq::poll_event::pollin);
+    }
+
+    return x;
+  }
+
+  template <class Algorithm, class Loss, class Logger, class Terminator,
+            class Encoder>
+  void solve(Algorithm *alg, Loss &&loss, Logger &&logger,
+             Terminator &&terminate, Encoder &&) {
+    static_assert(detail::dense<value_t, index_t, Encoder>::value,
+                  "Ring: only encoder::identity is supported.");
+    fval = std::forward<Loss>(loss)(xb_c, gb);
+    reduce();
+    while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
+      iterate(alg, std::forward<Logger>(logger));
+      fval = std::forward<Loss>(loss)(xb_c, gb);
+      reduce();
+    }
+  }
+
+  template <class Algorithm, class Loss, class Sampler, class Logger,
+            class Terminator, class Encoder>
+  void solve(Algorithm *alg, Loss &&loss,
+             utility::sampler::detail::component_sampler_t, Sampler &&sampler,
+             const index_t num_components, Logger &&logger,
+             Terminator &&terminate, Encoder &&) {
+    static_assert(detail::dense<value_t, index_t, Encoder>::value,
+                  "Ring: only encoder::identity is supported.");
+    std::vector<index_t> components(num_components);
+    index_t *cb = components.data();
+    index_t *ce = cb + components.size();
+    const index_t *cb_c = cb;
+    const index_t *ce_c = ce;
+
+    std::forward<Sampler>(sampler)(cb, ce);
+    fval = std::forward<Loss>(loss)(xb_c, gb, cb_c, ce_c);
+    reduce();
+    while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
+      iterate(alg, std::forward<Logger>(logger));
+      std::forward<Sampler>(sampler)(cb, ce);
+      fval = std::forward<Loss>(loss)(xb_c, gb, cb_c, ce_c);
+      reduce();
+    }
+  }
+
+  template <class Algorithm, class Loss, class Sampler, class Logger,
+            class Terminator, class Encoder>
+  void solve(Algorithm *alg, Loss &&loss,
+             utility::sampler::detail::coordinate_sampler_t, Sampler &&sampler,
+             const index_t num_coordinates, Logger &&logger,
+             Terminator &&terminate, Encoder &&encoder) {
+    static_assert(detail::dense<value_t, index_t, Encoder>::value,
+                  "Ring: only encoder::identity is supported.");
+    std::vector<index_t> coordinates(num_coordinates);
+    index_t *cb = coordinates.data();
+    index_t *ce = cb + coordinates.size();
+    const index_t *cb_c = cb;
+    const index_t *ce_c = ce;
+
+    fval = std::forward<Loss>(loss)(xb_c, gb);
+    std::forward<Sampler>(sampler)(cb, ce);
+    typename std::decay<Encoder>::type::result_type enc;
+    ::polo::encoder::encode(encoder, enc, gb_c, ge_c, cb_c, ce_c);
+    enc(gb, ge);
+    reduce();
+    while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
+      iterate(alg, std::forward<Logger>(logger));
+      fval = std::forward<Loss>(loss)(xb_c, gb);
+      std::forward<Sampler>(sampler)(cb, ce);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c, cb_c, ce_c);
+      enc(gb, ge);
+      reduce();
+    }
+  }
+
+  template <class Algorithm, class Loss, class Sampler1, class Sampler2,
+            class Logger, class Terminator, class Encoder>
+  void solve(Algorithm *alg, Loss &&loss,
+             utility::sampler::detail::component_sampler_t, Sampler1 &&sampler1,
+             const index_t num_components,
+             utility::sampler::detail::coordinate_sampler_t,
+             Sampler2 &&sampler2, const index_t num_coordinates,
+             Logger &&logger, Terminator &&terminate, Encoder &&encoder) {
+    static_assert(detail::dense<value_t, index_t, Encoder>::value,
+                  "Ring: only encoder::identity is supported.");
+    std::vector<index_t> components(num_components);
+    index_t *compb = components.data();
+    index_t *compe = compb + components.size();
+    const index_t *compb_c = compb;
+    const index_t *compe_c = compe;
+
+    std::vector<index_t> coordinates(num_coordinates);
+    index_t *coorb = coordinates.data();
+    index_t *coore = coorb + coordinates.size();
+    const index_t *coorb_c = coorb;
+    const index_t *coore_c = coore;
+
+    std::forward<Sampler1>(sampler1)(compb, compe);
+    fval = std::forward<Loss>(loss)(xb_c, gb, compb_c, compe_c);
+    std::forward<Sampler2>(sampler2)(coorb, coore);
+    typename std::decay<Encoder>::type::result_type enc;
+    ::polo::encoder::encode(encoder, enc, gb_c, ge_c, coorb_c, coore_c);
+    enc(gb, ge);
+    reduce();
+    while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
+      iterate(alg, std::forward<Logger>(logger));
+      std::forward<Sampler1>(sampler1)(compb, compe);
+      fval = std::forward<Loss>(loss)(xb_c, gb, compb_c, compe_c);
+      std::forward<Sampler2>(sampler2)(coorb, coore);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c, coorb_c, coore_c);
+      enc(gb, ge);
+      reduce();
+    }
+  }
+
+  value_t getf() const { return fval; }
+  std::vector<value_t> getx() const { return x; }
+
+  ~allreduce() = default;
+
+private:
+  template <class Algorithm, class Logger>
+  void iterate(Algorithm *alg, Logger &&logger) {
+    alg->boost(index_t(0), k, k, gb_c, ge_c, gb);
+    alg->smooth(k, k, xb_c, xe_c, gb_c, gb);
+    const value_t step = alg->step(k, k, fval, xb_c, xe_c, gb_c);
+    alg->prox(step, xb_c, xe_c, gb_c, xb);
+    std::forward<Logger>(logger)(k, fval, xb_c, xe_c, gb_c);
+    k++;
+  }
+
+  // Averages the gradient and the loss over all ranks. The loss travels as
+  // the last element of the buffer.
+  void reduce() {
+    std::copy(gb_c, ge_c, std::begin(buffer));
+    buffer.back() = fval;
+    if (nranks > 1)
+      exchange();
+
+    const value_t scale = value_t(1) / nranks;
+    std::transform(std::begin(buffer), std::end(buffer) - 1, gb,
+                   [=](const value_t val) { return val * scale; });
+    fval = buffer.back() * scale;
+  }
+
+  std::pair<std::size_t, std::size_t> bounds(const std::int32_t segment,
+                                             const std::int32_t chunk) const {
+    const std::size_t length = buffer.size();
+    const std::size_t sb = length * segment / nranks;
+    const std::size_t se = length * (segment + 1) / nranks;
+    return {sb + (se - sb) * chunk / nchunks,
+            sb + (se - sb) * (chunk + 1) / nchunks};
+  }
+
+  void forward(const std::uint32_t step, const std::int32_t segment,
+               const std::int32_t chunk) {
+    const auto range = bounds(segment, chunk);
+    const value_t *first = buffer.data() + range.first;
+    const value_t *last = buffer.data() + range.second;
+    msg.clear();
+    msg.addpart(detail::serialize(step));
+    msg.addpart(detail::serialize(std::uint32_t(chunk)));
+    msg.addpart(detail::serialize(communicator::wire::make_span(first, last)));
+    msg.send(right);
+  }
+
+  // Reduce-scatter followed by allgather. The segment received in one step is
+  // the one sent in the next, so each chunk is passed on as soon as it has
+  // been reduced and the steps overlap at chunk granularity.
+  void exchange() {
+    const std::uint32_t nsteps = 2 * (nranks - 1);
+    for (std::int32_t chunk = 0; chunk < nchunks; chunk++)
+      forward(0, rank, chunk);
+
+    for (std::uint32_t step = 0; step < nsteps; step++) {
+      const std::int32_t segment =
+          (rank + 2 * nranks - std::int32_t(step) - 1) % nranks;
+      for (std::int32_t chunk = 0; chunk < nchunks; chunk++) {
+        if (poll.poll(timeout) == 0)
+          throw std::runtime_error("Ring: No message from rank " +
+                                   std::to_string((rank + nranks - 1) %
+                                                  nranks) +
+                                   " for " + std::to_string(timeout) + " ms.");
+        msg.receive(left);
+
+        std::uint32_t rstep, rchunk;
+        detail::deserialize(msg, 0, rstep);
+        detail::deserialize(msg, 1, rchunk);
+        if (rstep != step || rchunk != std::uint32_t(chunk))
+          throw std::runtime_error("Ring: Out of order message at rank " +
+                                   std::to_string(rank) + ".");
+
+        const auto range = bounds(segment, chunk);
+        if (step < std::uint32_t(nranks - 1)) {
+          incoming.clear();
+          detail::deserialize_into<value_t>(msg, 2,
+                                            std::back_inserter(incoming));
+          std::transform(std::begin(incoming), std::end(incoming),
+                         std::begin(buffer) + range.first,
+                         std::begin(buffer) + range.first,
+                         std::plus<value_t>{});
+        } else
+          detail::deserialize_into<value_t>(msg, 2,
+                                            std::begin(buffer) + range.first);
+
+        if (step + 1 < nsteps)
+          forward(step + 1, segment, chunk);
+      }
+    }
+  }
+
+  int linger;
+  long timeout;
+  std::vector<std::string> peers;
+  std::int32_t rank{0}, nranks{1}, nchunks{1};
+  index_t k{1};
+  value_t fval{0};
+  value_t *xb, *gb, *ge;
+  const value_t *xb_c, *xe_c, *gb_c, *ge_c;
+  std::vector<value_t> x, g, buffer, incoming;
+  communicator::zmq::context ctx;
+  communicator::zmq::socket left{ctx, communicator::zmq::socket_type::pull},
+      right{ctx, communicator::zmq::socket_type::push};
+  communicator::zmq::poller poll;
+  communicator::zmq::message msg;
+};
+} // namespace ring
+} // namespace execution
+} // namespace polo
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef POLO_EXECUTION_SERIAL_HPP_
 #define POLO_EXECUTION_SERIAL_HPP_
 
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "polo/encoder/encode.hpp"
 #include "polo/utility/sampler.hpp"
 
 namespace polo {
@@ -38,12 +40,13 @@ protected:
   void solve(Algorithm *alg, Loss &&loss, Logger &&logger,
              Terminator &&terminate, Encoder &&encoder) {
     fval = std::forward<Loss>(loss)(xb_c, gb);
-    auto enc = std::forward<Encoder>(encoder)(gb_c, ge_c);
+    typename std::decay<Encoder>::type::result_type enc;
+    ::polo::encoder::encode(encoder, enc, gb_c, ge_c);
     enc(gb, ge);
     while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
       iterate(alg, std::forward<Logger>(logger));
       fval = std::forward<Loss>(loss)(xb_c, gb);
-      enc = std::forward<Encoder>(encoder)(gb_c, ge_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c);
       enc(gb, ge);
     }
   }
@@ -62,13 +65,14 @@ protected:
 
     std::forward<Sampler>(sampler)(cb, ce);
     fval = std::forward<Loss>(loss)(xb_c, gb, cb_c, ce_c);
-    auto enc = std::forward<Encoder>(encoder)(gb_c, ge_c);
+    typename std::decay<Encoder>::type::result_type enc;
+    ::polo::encoder::encode(encoder, enc, gb_c, ge_c);
     enc(gb, ge);
     while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
       iterate(alg, std::forward<Logger>(logger));
       std::forward<Sampler>(sampler)(cb, ce);
       fval = std::forward<Loss>(loss)(xb_c, gb, cb_c, ce_c);
-      enc = std::forward<Encoder>(encoder)(gb_c, ge_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c);
       enc(gb, ge);
     }
   }
@@ -87,13 +91,14 @@ protected:
 
     fval = std::forward<Loss>(loss)(xb_c, gb);
     std::forward<Sampler>(sampler)(cb, ce);
-    auto enc = std::forward<Encoder>(encoder)(gb_c, ge_c, cb_c, ce_c);
+    typename std::decay<Encoder>::type::result_type enc;
+    ::polo::encoder::encode(encoder, enc, gb_c, ge_c, cb_c, ce_c);
     enc(gb, ge);
     while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
       iterate(alg, std::forward<Logger>(logger));
       fval = std::forward<Loss>(loss)(xb_c, gb);
       std::forward<Sampler>(sampler)(cb, ce);
-      enc = std::forward<Encoder>(encoder)(gb_c, ge_c, cb_c, ce_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c, cb_c, ce_c);
       enc(gb, ge);
     }
   }
@@ -121,14 +126,15 @@ protected:
     std::forward<Sampler1>(sampler1)(compb, compe);
     fval = std::forward<Loss>(loss)(xb_c, gb, compb_c, compe_c);
     std::forward<Sampler2>(sampler2)(coorb, coore);
-    auto enc = std::forward<Encoder>(encoder)(gb_c, ge_c, coorb_c, coore_c);
+    typename std::decay<Encoder>::type::result_type enc;
+    ::polo::encoder::encode(encoder, enc, gb_c, ge_c, coorb_c, coore_c);
     enc(gb, ge);
     while (!std::forward<Terminator>(terminate)(k, fval, xb_c, xe_c, gb_c)) {
       iterate(alg, std::forward<Logger>(logger));
       std::forward<Sampler1>(sampler1)(compb, compe);
       fval = std::forward<Loss>(loss)(xb_c, gb, compb_c, compe_c);
       std::forward<Sampler2>(sampler2)(coorb, coore);
-      enc = std::forward<Encoder>(encoder)(gb_c, ge_c, coorb_c, coore_c);
+      ::polo::encoder::encode(encoder, enc, gb_c, ge_c, coorb_c, coore_c);
       enc(gb, ge);
     }
   }
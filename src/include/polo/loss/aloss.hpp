@@ -1,6 +1,9 @@
 #ifndef POLO_LOSS_ALOSS_HPP_
 #define POLO_LOSS_ALOSS_HPP_
 
+#include <algorithm>
+#include <vector>
+
 #include "polo/loss/data.hpp"
 
 namespace polo {
@@ -25,6 +28,22 @@ template <class value_t, class index_t> struct aloss {
   virtual value_t operator()(const value_t *x, value_t *g) const noexcept = 0;
   virtual value_t operator()(const value_t *x, value_t *g, const index_t *ib,
                              const index_t *ie) const noexcept = 0;
+  virtual value_t operator()(const value_t *x, value_t *g, const index_t *ib,
+                             const index_t *ie, const value_t *wb) const
+      noexcept {
+    const index_t d = nfeatures();
+    std::vector<value_t> gi(d);
+    std::fill(g, g + d, value_t{0});
+    value_t loss{0};
+    while (ib != ie) {
+      const value_t w = *wb++;
+      loss += w * operator()(x, gi.data(), ib, ib + 1);
+      for (index_t idx = 0; idx < d; idx++)
+        g[idx] += w * gi[idx];
+      ib++;
+    }
+    return loss;
+  }
 
   virtual ~aloss() = default;
 
@@ -13,6 +13,8 @@ struct leastsquares : public aloss<value_t, index_t> {
   leastsquares(data<value_t, index_t> data)
       : aloss<value_t, index_t>(std::move(data)) {}
 
+  using aloss<value_t, index_t>::operator();
+
   value_t operator()(const value_t *x, value_t *g) const noexcept override {
     value_t loss{0};
     std::vector<value_t> residual(aloss<value_t, index_t>::nsamples());
@@ -33,6 +35,21 @@ struct leastsquares : public aloss<value_t, index_t> {
                                                 ib, ie);
     return loss;
   }
+  value_t operator()(const value_t *x, value_t *g, const index_t *ib,
+                     const index_t *ie, const value_t *wb) const
+      noexcept override {
+    value_t loss{0};
+    std::vector<value_t> residual(std::distance(ib, ie));
+    aloss<value_t, index_t>::data_.residual(x, residual.data(), ib, ie);
+    for (value_t &r : residual) {
+      const value_t w = *wb++;
+      loss += 0.5 * w * r * r;
+      r *= w;
+    }
+    aloss<value_t, index_t>::matrix()->mult_add('t', 1, residual.data(), 0, g,
+                                                ib, ie);
+    return loss;
+  }
 };
 } // namespace loss
 } // namespace polo
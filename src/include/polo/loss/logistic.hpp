@@ -15,6 +15,8 @@ struct logistic : public aloss<value_t, index_t> {
   logistic(data<value_t, index_t> data)
       : aloss<value_t, index_t>(std::move(data)) {}
 
+  using aloss<value_t, index_t>::operator();
+
   value_t operator()(const value_t *x, value_t *g) const noexcept override {
     value_t loss{0};
     std::vector<value_t> ax(aloss<value_t, index_t>::nsamples());
@@ -62,6 +64,31 @@ struct logistic : public aloss<value_t, index_t> {
     A->mult_add('t', 1, &ax[0], 0, g, ib, ie);
     return loss;
   }
+  value_t operator()(const value_t *x, value_t *g, const index_t *ib,
+                     const index_t *ie, const value_t *wb) const
+      noexcept override {
+    value_t loss{0};
+    std::vector<value_t> ax(std::distance(ib, ie));
+    auto A = aloss<value_t, index_t>::matrix();
+    auto b = aloss<value_t, index_t>::labels();
+    A->mult_add('n', 1, x, 0, &ax[0], ib, ie);
+    const index_t *itemp{ib};
+    for (auto &val : ax) {
+      const value_t label = (*b)[*itemp++];
+      const value_t w = *wb++;
+      val *= -label;
+      const value_t temp = std::exp(val);
+      if (std::isinf(temp)) {
+        loss += w * val;
+        val = -w * label;
+      } else {
+        loss += w * std::log1p(temp);
+        val = -w * label * temp / (1 + temp);
+      }
+    }
+    A->mult_add('t', 1, &ax[0], 0, g, ib, ie);
+    return loss;
+  }
 };
 } // namespace loss
 } // namespace polo
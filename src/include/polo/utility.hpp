@@ -6,7 +6,10 @@
 #include "polo/utility/lapack.hpp"
 #include "polo/utility/logger.hpp"
 #include "polo/utility/null.hpp"
+#include "polo/utility/prefetch.hpp"
+#include "polo/utility/random.hpp"
 #include "polo/utility/reader.hpp"
 #include "polo/utility/sampler.hpp"
+#include "polo/utility/thread_pool.hpp"
 
 #endif
@@ -0,0 +1,180 @@
+#ifndef POLO_UTILITY_PREFETCH_HPP_
+#define POLO_UTILITY_PREFETCH_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "polo/loss/data.hpp"
+#include "polo/matrix/smatrix.hpp"
+#include "polo/utility/random.hpp"
+#include "polo/utility/sampler.hpp"
+
+namespace polo {
+namespace utility {
+namespace sampler {
+template <class value_t, class index_t = int, class Sampler = epoch<index_t>>
+struct prefetch {
+  using data_t = ::polo::loss::data<value_t, index_t>;
+
+  template <class Loss> struct blockwise_t {
+    blockwise_t(Loss loss, const prefetch *source)
+        : loss(std::move(loss)), source(source) {}
+
+    value_t operator()(const value_t *x, value_t *g) const {
+      return loss(x, g);
+    }
+    value_t operator()(const value_t *x, value_t *g, const index_t *ib,
+                       const index_t *ie) const {
+      const data_t *block = source->active;
+      const std::vector<index_t> &indices = source->currentindices;
+      if (block == nullptr || !block->matrix() ||
+          indices.size() != std::size_t(std::distance(ib, ie)) ||
+          !std::equal(ib, ie, std::begin(indices)))
+        return loss(x, g, ib, ie);
+      Loss local(loss);
+      local.data(*block);
+      return local(x, g);
+    }
+
+  private:
+    Loss loss;
+    const prefetch *source;
+  };
+
+  prefetch() = default;
+  prefetch(data_t data, Sampler sampler = Sampler{})
+      : sampler(std::move(sampler)), data(std::move(data)) {}
+  prefetch(const prefetch &rhs) : sampler(rhs.sampler), data(rhs.data) {}
+  prefetch &operator=(const prefetch &rhs) {
+    wait();
+    sampler = rhs.sampler;
+    data = rhs.data;
+    nextindices.clear();
+    currentindices.clear();
+    active = nullptr;
+    return *this;
+  }
+
+  prefetch split() {
+    wait();
+    return prefetch(data, utility::random::split(sampler));
+  }
+
+  template <class... Ts> void seed(const Ts &... seed) {
+    wait();
+    sampler.seed(seed...);
+    nextindices.clear();
+  }
+  template <class... Ts> void parameters(const Ts &... params) {
+    wait();
+    sampler.parameters(params...);
+    nextindices.clear();
+  }
+
+  template <class RandomIt>
+  RandomIt operator()(RandomIt sbegin, RandomIt send) {
+    const std::size_t d = std::distance(sbegin, send);
+    wait();
+    if (nextindices.size() != d) {
+      nextindices = std::vector<index_t>(d);
+      gather();
+    }
+    std::copy(std::begin(nextindices), std::end(nextindices), sbegin);
+    currentindices = nextindices;
+    std::swap(current, next);
+    active = &current;
+
+    if (!worker.joinable())
+      worker = std::thread(&prefetch::run, this);
+    {
+      std::lock_guard<std::mutex> lock(sync);
+      requested = true;
+    }
+    cv.notify_all();
+    return send;
+  }
+
+  const data_t &block() const noexcept { return current; }
+
+  template <class Loss> blockwise_t<Loss> blockwise(Loss loss) const {
+    return blockwise_t<Loss>(std::move(loss), this);
+  }
+
+  ~prefetch() {
+    if (worker.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(sync);
+        stopped = true;
+      }
+      cv.notify_all();
+      worker.join();
+    }
+  }
+
+private:
+  void wait() {
+    std::unique_lock<std::mutex> lock(sync);
+    cv.wait(lock, [this]() { return !requested; });
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(sync);
+    for (;;) {
+      cv.wait(lock, [this]() { return requested || stopped; });
+      if (stopped)
+        return;
+      lock.unlock();
+      gather();
+      lock.lock();
+      requested = false;
+      cv.notify_all();
+    }
+  }
+
+  void gather() {
+    sampler(std::begin(nextindices), std::end(nextindices));
+
+    auto A = data.matrix();
+    auto b = data.labels();
+    if (!A)
+      return;
+
+    const index_t nrows = nextindices.size();
+    std::vector<index_t> row_ptr(nrows + 1), cols;
+    std::vector<value_t> values, labels(nrows);
+
+    index_t row{0};
+    for (const index_t idx : nextindices) {
+      const auto rowcols = A->colindices(idx);
+      const auto rowvals = A->getrow(idx);
+      cols.insert(std::end(cols), std::begin(rowcols), std::end(rowcols));
+      values.insert(std::end(values), std::begin(rowvals), std::end(rowvals));
+      labels[row] = (*b)[idx];
+      row_ptr[++row] = cols.size();
+    }
+
+    next = data_t(::polo::matrix::smatrix<value_t, index_t>(
+                      nrows, A->ncols(), std::move(row_ptr), std::move(cols),
+                      std::move(values)),
+                  std::move(labels));
+  }
+
+  Sampler sampler;
+  data_t data, current, next;
+  const data_t *active{nullptr};
+  std::vector<index_t> currentindices, nextindices;
+  bool requested{false}, stopped{false};
+  std::mutex sync;
+  std::condition_variable cv;
+  std::thread worker;
+};
+} // namespace sampler
+} // namespace utility
+} // namespace polo
+
+#endif
@@ -0,0 +1,322 @@
+#ifndef POLO_UTILITY_RANDOM_HPP_
+#define POLO_UTILITY_RANDOM_HPP_
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <utility>
+
+namespace polo {
+namespace utility {
+namespace random {
+namespace detail {
+inline std::uint64_t splitmix64(std::uint64_t &state) noexcept {
+  std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+// Identifies the child created by the n-th split of the generator at path,
+// so a split tree never hands the same stream to two nodes.
+inline std::uint64_t descend(const std::uint64_t path,
+                             const std::uint64_t n) noexcept {
+  std::uint64_t state = path * 0xd1342543de82ef95 + n;
+  return splitmix64(state);
+}
+
+struct fallback {};
+struct seeded : fallback {};
+struct member : seeded {};
+
+template <class T>
+auto split(T &parent, member) -> decltype(parent.split()) {
+  return parent.split();
+}
+template <class T>
+auto split(T &parent, seeded)
+    -> decltype(parent(), T(std::declval<std::seed_seq &>())) {
+  std::seed_seq seq{parent(), parent(), parent(), parent()};
+  return T(seq);
+}
+template <class T> T split(T &parent, fallback) { return parent; }
+} // namespace detail
+
+struct xoshiro256ss {
+  using result_type = std::uint64_t;
+
+  static constexpr result_type default_seed = 5489u;
+  static constexpr result_type min() noexcept { return 0; }
+  static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  explicit xoshiro256ss(const result_type value = default_seed) noexcept {
+    seed(value);
+  }
+
+  void seed(const result_type value = default_seed) noexcept {
+    key = value;
+    restart(0);
+  }
+
+  result_type operator()() noexcept {
+    const result_type result = rotl(state[1] * 5, 7) * 9;
+    const result_type t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+
+  template <class OutputIt> OutputIt generate(OutputIt first, OutputIt last) {
+    while (first != last)
+      *first++ = operator()();
+    return last;
+  }
+
+  void discard(unsigned long long n) noexcept {
+    while (n-- > 0)
+      operator()();
+  }
+
+  void jump() noexcept {
+    static constexpr result_type polynomial[] = {
+        0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+        0x39abdc4529b1661c};
+    advance(polynomial);
+  }
+  void long_jump() noexcept {
+    static constexpr result_type polynomial[] = {
+        0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241,
+        0x39109bb02acbe635};
+    advance(polynomial);
+  }
+
+  xoshiro256ss split() noexcept {
+    xoshiro256ss child(*this);
+    child.restart(detail::descend(path, ++splits));
+    return child;
+  }
+
+  friend bool operator==(const xoshiro256ss &lhs,
+                         const xoshiro256ss &rhs) noexcept {
+    return lhs.state == rhs.state;
+  }
+  friend bool operator!=(const xoshiro256ss &lhs,
+                         const xoshiro256ss &rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+private:
+  static result_type rotl(const result_type x, const int k) noexcept {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  void restart(const std::uint64_t id) noexcept {
+    path = id;
+    splits = 0;
+    result_type value = key ^ id;
+    for (auto &s : state)
+      s = detail::splitmix64(value);
+  }
+
+  void advance(const result_type (&polynomial)[4]) noexcept {
+    std::array<result_type, 4> s{{0, 0, 0, 0}};
+    for (const result_type word : polynomial)
+      for (int b = 0; b < 64; b++) {
+        if (word & (result_type{1} << b))
+          for (int idx = 0; idx < 4; idx++)
+            s[idx] ^= state[idx];
+        operator()();
+      }
+    state = s;
+  }
+
+  std::array<result_type, 4> state;
+  std::uint64_t key, path, splits;
+};
+
+struct philox4x32 {
+  using result_type = std::uint32_t;
+
+  static constexpr std::uint64_t default_seed = 20111115u;
+  static constexpr result_type min() noexcept { return 0; }
+  static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  static constexpr std::uint64_t split_bit = std::uint64_t{1} << 63;
+
+  explicit philox4x32(const std::uint64_t value = default_seed,
+                      const std::uint64_t stream = 0) noexcept {
+    seed(value, stream);
+  }
+
+  void seed(const std::uint64_t value = default_seed,
+            const std::uint64_t stream = 0) noexcept {
+    key = {{result_type(value), result_type(value >> 32)}};
+    restart(stream & ~split_bit);
+  }
+
+  result_type operator()() noexcept {
+    if (idx == 4) {
+      buffer = block(counter, key);
+      increment(counter, 1);
+      idx = 0;
+    }
+    return buffer[idx++];
+  }
+
+  template <class OutputIt> OutputIt generate(OutputIt first, OutputIt last) {
+    while (idx != 4 && first != last)
+      *first++ = buffer[idx++];
+    std::array<result_type, 16> batch;
+    while (std::distance(first, last) >= 16) {
+      blocks(counter, key, batch);
+      increment(counter, 4);
+      for (const result_type value : batch)
+        *first++ = value;
+    }
+    while (std::distance(first, last) >= 4) {
+      const std::array<result_type, 4> values = block(counter, key);
+      increment(counter, 1);
+      for (const result_type value : values)
+        *first++ = value;
+    }
+    while (first != last)
+      *first++ = operator()();
+    return last;
+  }
+
+  void discard(unsigned long long n) noexcept {
+    while (idx != 4 && n > 0) {
+      idx++;
+      n--;
+    }
+    increment(counter, n / 4);
+    n %= 4;
+    if (n > 0) {
+      operator()();
+      idx = n;
+    }
+  }
+
+  void jump() noexcept {
+    id = ((id & ~split_bit) + 1) | split_bit;
+    counter[2] = result_type(id);
+    counter[3] = result_type(id >> 32);
+    if (idx != 4) {
+      std::array<result_type, 4> previous = counter;
+      decrement(previous);
+      buffer = block(previous, key);
+    }
+  }
+
+  philox4x32 split() noexcept {
+    philox4x32 child(*this);
+    child.restart(detail::descend(id, ++splits) | split_bit);
+    return child;
+  }
+
+  static std::array<result_type, 4>
+  block(std::array<result_type, 4> ctr,
+        std::array<result_type, 2> k) noexcept {
+    for (int round = 0; round < 10; round++) {
+      const std::uint64_t p0 = std::uint64_t{0xD2511F53} * ctr[0];
+      const std::uint64_t p1 = std::uint64_t{0xCD9E8D57} * ctr[2];
+      ctr = {{result_type(p1 >> 32) ^ ctr[1] ^ k[0], result_type(p1),
+              result_type(p0 >> 32) ^ ctr[3] ^ k[1], result_type(p0)}};
+      k[0] += 0x9E3779B9;
+      k[1] += 0xBB67AE85;
+    }
+    return ctr;
+  }
+
+  static void blocks(const std::array<result_type, 4> &ctr,
+                     std::array<result_type, 2> k,
+                     std::array<result_type, 16> &out) noexcept {
+    result_type c0[4], c1[4], c2[4], c3[4];
+    for (int lane = 0; lane < 4; lane++) {
+      std::array<result_type, 4> c = ctr;
+      increment(c, lane);
+      c0[lane] = c[0];
+      c1[lane] = c[1];
+      c2[lane] = c[2];
+      c3[lane] = c[3];
+    }
+    for (int round = 0; round < 10; round++) {
+      for (int lane = 0; lane < 4; lane++) {
+        const std::uint64_t p0 = std::uint64_t{0xD2511F53} * c0[lane];
+        const std::uint64_t p1 = std::uint64_t{0xCD9E8D57} * c2[lane];
+        c0[lane] = result_type(p1 >> 32) ^ c1[lane] ^ k[0];
+        c1[lane] = result_type(p1);
+        c2[lane] = result_type(p0 >> 32) ^ c3[lane] ^ k[1];
+        c3[lane] = result_type(p0);
+      }
+      k[0] += 0x9E3779B9;
+      k[1] += 0xBB67AE85;
+    }
+    for (int lane = 0; lane < 4; lane++) {
+      out[4 * lane] = c0[lane];
+      out[4 * lane + 1] = c1[lane];
+      out[4 * lane + 2] = c2[lane];
+      out[4 * lane + 3] = c3[lane];
+    }
+  }
+
+  friend bool operator==(const philox4x32 &lhs,
+                         const philox4x32 &rhs) noexcept {
+    return lhs.key == rhs.key && lhs.counter == rhs.counter &&
+           lhs.idx == rhs.idx;
+  }
+  friend bool operator!=(const philox4x32 &lhs,
+                         const philox4x32 &rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+private:
+  void restart(const std::uint64_t stream) noexcept {
+    id = stream;
+    splits = 0;
+    counter = {{0, 0, result_type(stream), result_type(stream >> 32)}};
+    idx = 4;
+  }
+
+  static void increment(std::array<result_type, 4> &ctr,
+                        const unsigned long long n) noexcept {
+    const std::uint64_t low = (std::uint64_t(ctr[1]) << 32) | ctr[0];
+    const std::uint64_t sum = low + n;
+    ctr[0] = result_type(sum);
+    ctr[1] = result_type(sum >> 32);
+    if (sum < low && ++ctr[2] == 0)
+      ++ctr[3];
+  }
+  static void decrement(std::array<result_type, 4> &ctr) noexcept {
+    for (auto &word : ctr)
+      if (word-- != 0)
+        break;
+  }
+
+  std::array<result_type, 2> key;
+  std::array<result_type, 4> counter, buffer;
+  unsigned int idx{4};
+  std::uint64_t id, splits;
+};
+
+// Returns an independent copy of parent: generators, samplers and encoders
+// with a split() member derive a new stream from it, other standard engines
+// are reseeded from their next outputs, and anything else is copied.
+template <class T> T split(T &parent) {
+  return detail::split(parent, detail::member{});
+}
+} // namespace random
+} // namespace utility
+} // namespace polo
+
+#endif
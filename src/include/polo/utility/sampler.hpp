@@ -1,34 +1,243 @@
 #ifndef POLO_UTILITY_SAMPLER_HPP_
 #define POLO_UTILITY_SAMPLER_HPP_
 
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <random>
-#include <set>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "polo/utility/random.hpp"
 
 namespace polo {
 namespace utility {
 namespace sampler {
 namespace detail {
+template <class index_t> struct alias_distribution {
+  using result_type = index_t;
+
+  struct param_type {
+    param_type() : param_type({1.0}) {}
+    template <class InputIt> param_type(InputIt first, InputIt last) {
+      auto t = std::make_shared<table_t>();
+      t->probs = std::vector<double>(first, last);
+      const std::size_t n = t->probs.size();
+      const double total =
+          std::accumulate(std::begin(t->probs), std::end(t->probs), 0.0);
+      std::vector<double> scaled(n);
+      std::vector<std::size_t> small, large;
+      for (std::size_t idx = 0; idx < n; idx++) {
+        t->probs[idx] /= total;
+        scaled[idx] = t->probs[idx] * n;
+        (scaled[idx] < 1 ? small : large).push_back(idx);
+      }
+      t->threshold = std::vector<double>(n, 1);
+      t->alias = std::vector<index_t>(n);
+      std::iota(std::begin(t->alias), std::end(t->alias), index_t{0});
+      while (!small.empty() && !large.empty()) {
+        const std::size_t s = small.back(), l = large.back();
+        small.pop_back();
+        t->threshold[s] = scaled[s];
+        t->alias[s] = index_t(l);
+        scaled[l] -= 1 - scaled[s];
+        if (scaled[l] < 1) {
+          large.pop_back();
+          small.push_back(l);
+        }
+      }
+      table = std::move(t);
+    }
+    param_type(std::initializer_list<double> weights)
+        : param_type(std::begin(weights), std::end(weights)) {}
+
+    std::vector<double> probabilities() const { return table->probs; }
+
+  private:
+    friend struct alias_distribution;
+    struct table_t {
+      std::vector<double> probs, threshold;
+      std::vector<index_t> alias;
+    };
+    std::shared_ptr<const table_t> table;
+  };
+
+  alias_distribution() = default;
+  explicit alias_distribution(param_type p) : p(std::move(p)) {}
+  template <class InputIt>
+  alias_distribution(InputIt first, InputIt last) : p(first, last) {}
+
+  void reset() {}
+  param_type param() const { return p; }
+  void param(param_type params) { p = std::move(params); }
+
+  result_type min() const noexcept { return 0; }
+  result_type max() const noexcept {
+    return index_t(p.table->probs.size()) - 1;
+  }
+  double probability(const index_t idx) const { return p.table->probs[idx]; }
+
+  template <class generator_t> result_type operator()(generator_t &gen) {
+    std::uniform_int_distribution<index_t> column(min(), max());
+    std::uniform_real_distribution<double> coin;
+    const index_t idx = column(gen);
+    return coin(gen) < p.table->threshold[idx] ? idx : p.table->alias[idx];
+  }
+
+private:
+  param_type p;
+};
+
+template <class index_t> struct dynamic_distribution {
+  using result_type = index_t;
+
+  struct param_type {
+    param_type() : weights{1} {}
+    template <class InputIt>
+    param_type(InputIt first, InputIt last) : weights(first, last) {}
+    param_type(std::initializer_list<double> weights) : weights(weights) {}
+
+    std::vector<double> weights;
+  };
+
+  dynamic_distribution() : dynamic_distribution(param_type{}) {}
+  explicit dynamic_distribution(const param_type &p)
+      : state(std::make_shared<state_t>()) {
+    param(p);
+  }
+  template <class InputIt>
+  dynamic_distribution(InputIt first, InputIt last)
+      : dynamic_distribution(param_type(first, last)) {}
+
+  void reset() {}
+  param_type param() const {
+    std::lock_guard<std::mutex> lock(state->sync);
+    return param_type(std::begin(state->weights), std::end(state->weights));
+  }
+  void param(const param_type &p) {
+    std::lock_guard<std::mutex> lock(state->sync);
+    const std::size_t n = p.weights.size();
+    state->weights = p.weights;
+    state->tree = std::vector<double>(n + 1, 0);
+    for (std::size_t idx = 1; idx <= n; idx++) {
+      state->tree[idx] += p.weights[idx - 1];
+      const std::size_t parent = idx + (idx & (~idx + 1));
+      if (parent <= n)
+        state->tree[parent] += state->tree[idx];
+    }
+    state->top = 1;
+    while (2 * state->top <= n)
+      state->top *= 2;
+  }
+
+  void update(const index_t idx, const double weight) {
+    std::lock_guard<std::mutex> lock(state->sync);
+    const double delta = weight - state->weights[idx];
+    state->weights[idx] = weight;
+    const std::size_t n = state->weights.size();
+    for (std::size_t pos = std::size_t(idx) + 1; pos <= n;
+         pos += pos & (~pos + 1))
+      state->tree[pos] += delta;
+  }
+  template <class InputIt1, class InputIt2>
+  void update(InputIt1 ib, InputIt1 ie, InputIt2 wb) {
+    while (ib != ie)
+      update(*ib++, *wb++);
+  }
+
+  double weight(const index_t idx) const {
+    std::lock_guard<std::mutex> lock(state->sync);
+    return state->weights[idx];
+  }
+  double probability(const index_t idx) const {
+    std::lock_guard<std::mutex> lock(state->sync);
+    return state->weights[idx] / total();
+  }
+
+  result_type min() const noexcept { return 0; }
+  result_type max() const {
+    std::lock_guard<std::mutex> lock(state->sync);
+    return index_t(state->weights.size()) - 1;
+  }
+
+  template <class generator_t> result_type operator()(generator_t &gen) {
+    std::lock_guard<std::mutex> lock(state->sync);
+    const std::size_t n = state->weights.size();
+    double target = std::uniform_real_distribution<double>(0, total())(gen);
+    std::size_t pos{0};
+    for (std::size_t step = state->top; step > 0; step /= 2)
+      if (pos + step <= n && state->tree[pos + step] <= target) {
+        pos += step;
+        target -= state->tree[pos];
+      }
+    while (pos > 0 && (pos == n || state->weights[pos] <= 0))
+      pos--;
+    return index_t(pos);
+  }
+
+private:
+  double total() const noexcept {
+    double sum{0};
+    for (std::size_t pos = state->weights.size(); pos > 0;
+         pos -= pos & (~pos + 1))
+      sum += state->tree[pos];
+    return sum;
+  }
+
+  struct state_t {
+    std::mutex sync;
+    std::vector<double> weights, tree;
+    std::size_t top{1};
+  };
+  std::shared_ptr<state_t> state;
+};
+
 template <class index_t, template <class> class distribution_t,
           class generator_t = std::mt19937>
 struct sampler : private distribution_t<index_t> {
   using param_type = typename distribution_t<index_t>::param_type;
   using result_type = typename distribution_t<index_t>::result_type;
 
+  template <class Loss> struct weighted_t {
+    weighted_t(Loss loss, distribution_t<index_t> dist)
+        : loss(std::move(loss)), dist(std::move(dist)) {}
+
+    template <class value_t>
+    value_t operator()(const value_t *x, value_t *g) const {
+      return loss(x, g);
+    }
+    template <class value_t>
+    value_t operator()(const value_t *x, value_t *g, const index_t *ib,
+                       const index_t *ie) const {
+      std::vector<value_t> w(std::distance(ib, ie));
+      correction(dist, ib, ie, std::begin(w));
+      return loss(x, g, ib, ie, w.data());
+    }
+
+  private:
+    Loss loss;
+    distribution_t<index_t> dist;
+  };
+
   sampler() = default;
-  sampler(distribution_t<index_t> dist, generator_t gen = std::mt19937{})
+  sampler(distribution_t<index_t> dist, generator_t gen = generator_t{})
       : distribution_t<index_t>(std::move(dist)), gen(std::move(gen)) {}
-  sampler(const sampler &s)
-      : distribution_t<index_t>(s), gen(std::random_device{}()) {}
-  sampler &operator=(const sampler &rhs) {
-    distribution_t<index_t>::operator=(rhs);
-    gen = generator_t(std::random_device{}());
-    return *this;
-  }
+  sampler(const sampler &) = default;
+  sampler &operator=(const sampler &) = default;
   sampler(sampler &&) = default;
   sampler &operator=(sampler &&) = default;
 
+  sampler split() {
+    return sampler(static_cast<const distribution_t<index_t> &>(*this),
+                   random::split(gen));
+  }
+
   template <class... Ts> void seed(const Ts &... seed) { gen.seed(seed...); }
 
   template <class... Ts> void parameters(const Ts &... params) {
@@ -39,24 +248,153 @@ struct sampler : private distribution_t<index_t> {
   }
   param_type parameters() const { return distribution_t<index_t>::param(); }
 
-  template <class OutputIt>
-  OutputIt operator()(OutputIt sbegin, OutputIt send) {
+  template <class... Ts> void update(const Ts &... args) {
+    distribution_t<index_t>::update(args...);
+  }
+
+  template <class InputIt, class OutputIt, class D = distribution_t<index_t>,
+            class = decltype(std::declval<const D &>().probability(index_t{}))>
+  OutputIt correction(InputIt ib, InputIt ie, OutputIt wb) const {
+    return correction(*this, ib, ie, wb);
+  }
+
+  template <class Loss, class D = distribution_t<index_t>,
+            class = decltype(std::declval<const D &>().probability(index_t{}))>
+  weighted_t<Loss> weighted(Loss loss) const {
+    return weighted_t<Loss>(std::move(loss), *this);
+  }
+
+  template <class RandomIt>
+  RandomIt operator()(RandomIt sbegin, RandomIt send) {
+    const index_t lo = distribution_t<index_t>::min();
+    const std::size_t n = std::size_t(distribution_t<index_t>::max() - lo) + 1;
+    const std::size_t d = std::distance(sbegin, send);
+    if (marks.size() != n)
+      marks = std::vector<bool>(n, false);
+
+    draw(sbegin, send, lo, n,
+         std::is_same<distribution_t<index_t>,
+                      std::uniform_int_distribution<index_t>>{});
+
+    if (d * std::log2(d + 1) < n) {
+      std::sort(sbegin, send);
+      for (RandomIt stemp = sbegin; stemp != send; stemp++)
+        marks[*stemp - lo] = false;
+    } else {
+      RandomIt stemp{sbegin};
+      for (std::size_t idx = 0; idx < n; idx++)
+        if (marks[idx]) {
+          *stemp++ = lo + index_t(idx);
+          marks[idx] = false;
+        }
+    }
+    return send;
+  }
+
+private:
+  template <class InputIt, class OutputIt>
+  static OutputIt correction(const distribution_t<index_t> &dist, InputIt ib,
+                             InputIt ie, OutputIt wb) {
+    const double n = double(dist.max() - dist.min()) + 1;
+    while (ib != ie)
+      *wb++ = 1 / (n * dist.probability(*ib++));
+    return wb;
+  }
+
+  template <class RandomIt>
+  void draw(RandomIt sbegin, RandomIt send, const index_t lo,
+            const std::size_t n, std::true_type) {
+    const std::size_t d = std::distance(sbegin, send);
+    for (std::size_t j = n - d; j < n; j++) {
+      index_t val = distribution_t<index_t>::operator()(
+          gen, param_type(lo, lo + index_t(j)));
+      if (marks[val - lo])
+        val = lo + index_t(j);
+      marks[val - lo] = true;
+      *sbegin++ = val;
+    }
+  }
+  template <class RandomIt>
+  void draw(RandomIt sbegin, RandomIt send, const index_t lo,
+            const std::size_t, std::false_type) {
     index_t val;
-    std::set<index_t> values;
-    const size_t d = std::distance(sbegin, send);
-    while (values.size() != d) {
+    while (sbegin != send) {
       do {
         val = distribution_t<index_t>::operator()(gen);
-      } while (values.count(val) == 1);
-      values.insert(val);
-    }
-    for (const index_t val : values)
+      } while (marks[val - lo]);
+      marks[val - lo] = true;
       *sbegin++ = val;
-    return sbegin;
+    }
+  }
+
+  generator_t gen;
+  std::vector<bool> marks;
+};
+
+template <class index_t, class generator_t> struct epoch {
+  epoch() = default;
+  epoch(generator_t gen) : gen(std::move(gen)) {}
+  epoch(const epoch &) = default;
+  epoch &operator=(const epoch &) = default;
+  epoch(epoch &&) = default;
+  epoch &operator=(epoch &&) = default;
+
+  epoch split() {
+    epoch child(*this);
+    child.gen = random::split(gen);
+    return child;
+  }
+
+  template <class... Ts> void seed(const Ts &... seed) { gen.seed(seed...); }
+
+  void parameters(const index_t a, const index_t b) {
+    lo = a;
+    hi = b;
+    perm = std::vector<index_t>(std::size_t(b - a) + 1);
+    index_t val{a};
+    for (auto &idx : perm)
+      idx = val++;
+    cursor = 0;
+    nepochs = 0;
+  }
+  std::pair<index_t, index_t> parameters() const { return {lo, hi}; }
+
+  std::size_t epochs() const noexcept { return nepochs; }
+
+  template <class RandomIt>
+  RandomIt operator()(RandomIt sbegin, RandomIt send) {
+    const std::size_t n = perm.size();
+    const std::size_t d = std::distance(sbegin, send);
+    if (d > n)
+      throw std::domain_error("epoch: minibatch is larger than the range");
+
+    // The rest of the current epoch goes into this minibatch, and the next
+    // epoch fills it up from the other indices. These stay at the back of
+    // perm, so they are still drawn once in the new epoch.
+    RandomIt stemp{sbegin};
+    std::size_t limit{n};
+    if (cursor + d > n) {
+      stemp = std::copy(std::begin(perm) + cursor, std::end(perm), stemp);
+      limit = cursor;
+      cursor = 0;
+      nepochs++;
+    }
+    const std::size_t last = cursor + std::distance(stemp, send);
+    for (std::size_t idx = cursor; idx < last; idx++) {
+      std::uniform_int_distribution<std::size_t> dist(idx, limit - 1);
+      std::swap(perm[idx], perm[dist(gen)]);
+      *stemp++ = perm[idx];
+    }
+    cursor = last;
+    std::sort(sbegin, send);
+    return send;
   }
 
 private:
   generator_t gen;
+  index_t lo{0}, hi{0};
+  std::vector<index_t> perm;
+  std::size_t cursor{0}, nepochs{0};
 };
 
 struct coordinate_sampler_t {};
@@ -69,6 +407,14 @@ using uniform =
 template <class index_t = int, class generator_t = std::mt19937>
 using custom =
     detail::sampler<index_t, std::discrete_distribution, generator_t>;
+template <class index_t = int, class generator_t = std::mt19937>
+using alias =
+    detail::sampler<index_t, detail::alias_distribution, generator_t>;
+template <class index_t = int, class generator_t = std::mt19937>
+using dynamic =
+    detail::sampler<index_t, detail::dynamic_distribution, generator_t>;
+template <class index_t = int, class generator_t = std::mt19937>
+using epoch = detail::epoch<index_t, generator_t>;
 
 constexpr detail::coordinate_sampler_t coordinate;
 constexpr detail::component_sampler_t component;
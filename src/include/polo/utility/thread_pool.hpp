@@ -0,0 +1,76 @@
+#ifndef POLO_UTILITY_THREAD_POOL_HPP_
+#define POLO_UTILITY_THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace polo {
+namespace utility {
+// Fixed set of threads that all run the same task, given their own index, and
+// wait for the next one. run() blocks until every thread has finished, so the
+// task is only referenced, never copied.
+class thread_pool {
+public:
+  explicit thread_pool(const std::size_t n) {
+    for (std::size_t t = 0; t < n; t++)
+      threads.emplace_back(&thread_pool::loop, this, t);
+  }
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  std::size_t size() const noexcept { return threads.size(); }
+
+  template <class Task> void run(Task &task) {
+    std::unique_lock<std::mutex> lock(sync);
+    context = &task;
+    invoke = [](void *task, const std::size_t t) {
+      (*static_cast<Task *>(task))(t);
+    };
+    pending = threads.size();
+    generation++;
+    cv.notify_all();
+    done.wait(lock, [this]() { return pending == 0; });
+  }
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(sync);
+      stopped = true;
+    }
+    cv.notify_all();
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+private:
+  void loop(const std::size_t t) {
+    std::size_t seen{0};
+    std::unique_lock<std::mutex> lock(sync);
+    for (;;) {
+      cv.wait(lock, [&]() { return stopped || generation != seen; });
+      if (stopped)
+        return;
+      seen = generation;
+      lock.unlock();
+      invoke(context, t);
+      lock.lock();
+      if (--pending == 0)
+        done.notify_all();
+    }
+  }
+
+  std::vector<std::thread> threads;
+  void *context{nullptr};
+  void (*invoke)(void *, std::size_t){nullptr};
+  std::size_t pending{0}, generation{0};
+  bool stopped{false};
+  std::mutex sync;
+  std::condition_variable cv, done;
+};
+} // namespace utility
+} // namespace polo
+
+#endif
@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "polo/communicator/wire.hpp"
+#include "polo/encoder.hpp"
+#include "gtest/gtest.h"
+
+template <class T> std::vector<char> pack(const T &value) {
+  std::vector<char> buffer(polo::communicator::wire::size(value));
+  polo::communicator::wire::writer ar(buffer.data(), buffer.size());
+  ar(value);
+  EXPECT_EQ(ar.size(), buffer.size());
+  return buffer;
+}
+
+template <class T> T unpack(const std::vector<char> &buffer) {
+  T value;
+  polo::communicator::wire::reader ar(buffer.data(), buffer.size());
+  ar(value);
+  EXPECT_EQ(ar.size(), buffer.size());
+  return value;
+}
+
+template <class Encoder>
+void roundtrip(Encoder encoder, const std::vector<double> &x) {
+  std::vector<double> expected(x.size()), actual(x.size());
+  const auto v1 = encoder(x.data(), x.data() + x.size());
+  v1(std::begin(expected), std::end(expected));
+
+  const auto buffer = pack(v1);
+  EXPECT_EQ(v1.size(), buffer.size());
+  const auto v2 = unpack<typename Encoder::result_type>(buffer);
+  v2(std::begin(actual), std::end(actual));
+
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_DOUBLE_EQ(actual[idx], expected[idx]);
+}
+
+TEST(Wire, Layout) {
+  const std::uint16_t tag{0x0102};
+  const std::vector<std::int32_t> values{0x03040506};
+  polo::communicator::wire::sizer sizer;
+  sizer(tag, values);
+  std::vector<char> buffer(sizer.size());
+  polo::communicator::wire::writer ar(buffer.data(), buffer.size());
+  ar(tag, values);
+
+  const std::vector<char> expected{2, 1, 0, 0, 0, 0, 0, 0, 1, 0,
+                                   0, 0, 0, 0, 0, 0, 6, 5, 4, 3};
+  ASSERT_EQ(ar.size(), expected.size());
+  for (size_t idx = 0; idx < expected.size(); idx++)
+    EXPECT_EQ(buffer[idx], expected[idx]);
+}
+
+TEST(Wire, Vector) {
+  const std::vector<double> x{-5, 1, 12, -7, 0, 0, -100, 500, 6, -30};
+  const auto y = unpack<std::vector<double>>(pack(x));
+  ASSERT_EQ(y.size(), x.size());
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_DOUBLE_EQ(y[idx], x[idx]);
+
+  const auto buffer = pack(polo::communicator::wire::make_span(
+      x.data() + 2, x.data() + x.size()));
+  std::vector<double> z(x.size() - 2);
+  polo::communicator::wire::reader ar(buffer.data(), buffer.size());
+  ar.extract<double>(std::begin(z));
+  for (size_t idx = 0; idx < z.size(); idx++)
+    EXPECT_DOUBLE_EQ(z[idx], x[idx + 2]);
+}
+
+TEST(Wire, Encoders) {
+  const std::vector<double> x{-5, 1, 12, -7, 0, 0, -100, 500, 6, -30};
+  roundtrip(polo::encoder::identity<double, int>{}, x);
+  roundtrip(polo::encoder::topk<double, int>{3}, x);
+  roundtrip(polo::encoder::ternary<double, int>{}, x);
+  roundtrip(polo::encoder::dynamic<double, int>{}, x);
+  roundtrip(polo::encoder::random_quantizer<double, int>{}, x);
+  roundtrip(polo::encoder::random_sparsifier<double, int>{x.size(), 0.5}, x);
+  roundtrip(polo::encoder::qsgd<double, int>{}, x);
+  roundtrip(polo::encoder::qsgd<double, int, 2>{1, 4}, x);
+}
+
+TEST(Wire, Truncated) {
+  const std::vector<double> x{1, 2, 3};
+  auto buffer = pack(x);
+  buffer.pop_back();
+  EXPECT_THROW(unpack<std::vector<double>>(buffer), std::range_error);
+}
@@ -0,0 +1,70 @@
+#include <iterator>
+#include <vector>
+
+#include "polo/encoder/error_feedback.hpp"
+#include "polo/encoder/topk.hpp"
+#include "gtest/gtest.h"
+
+class EncoderErrorFeedback
+    : public polo::encoder::error_feedback<double, int,
+                                           polo::encoder::topk<double, int>>,
+      public ::testing::Test {
+protected:
+  EncoderErrorFeedback()
+      : polo::encoder::error_feedback<double, int,
+                                      polo::encoder::topk<double, int>>{
+            polo::encoder::topk<double, int>{3}},
+        x{-5, 1, 12, -7, 0, 0, -100, 500, 6, -30} {}
+  void SetUp() override {}
+  void TearDown() override {}
+  ~EncoderErrorFeedback() override = default;
+
+  const std::vector<double> x;
+};
+
+TEST_F(EncoderErrorFeedback, FullGradient) {
+  std::vector<double> actual(x.size());
+  auto v = operator()(std::begin(x), std::end(x));
+  v(std::begin(actual), std::end(actual));
+
+  std::vector<double> expected{0, 0, 0, 0, 0, 0, -100, 500, 0, -30};
+  for (size_t idx = 0; idx < x.size(); idx++) {
+    EXPECT_DOUBLE_EQ(actual[idx], expected[idx]);
+    EXPECT_DOUBLE_EQ(memory()[idx], x[idx] - expected[idx]);
+  }
+
+  const std::vector<double> zero(x.size());
+  v = operator()(std::begin(zero), std::end(zero));
+  v(std::begin(actual), std::end(actual));
+
+  expected = {0, 0, 12, -7, 0, 0, 0, 0, 6, 0};
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_DOUBLE_EQ(actual[idx], expected[idx]);
+}
+
+TEST_F(EncoderErrorFeedback, Conservation) {
+  std::vector<double> sent(x.size()), actual(x.size());
+  for (int k = 1; k <= 5; k++) {
+    auto v = operator()(std::begin(x), std::end(x));
+    v(std::begin(actual), std::end(actual));
+    for (size_t idx = 0; idx < x.size(); idx++) {
+      sent[idx] += actual[idx];
+      EXPECT_DOUBLE_EQ(sent[idx] + memory()[idx], k * x[idx]);
+    }
+  }
+}
+
+TEST_F(EncoderErrorFeedback, BlockCoordinate) {
+  std::vector<double> actual(x.size());
+  const std::vector<int> block{0, 1, 2, 3, 9};
+  auto v = operator()(std::begin(x), std::end(x), std::begin(block),
+                      std::end(block));
+  v(std::begin(actual), std::end(actual));
+
+  const std::vector<double> expected{0, 0, 12, -7, 0, 0, 0, 0, 0, -30};
+  const std::vector<double> residual{-5, 1, 0, 0, 0, 0, 0, 0, 0, 0};
+  for (size_t idx = 0; idx < x.size(); idx++) {
+    EXPECT_DOUBLE_EQ(actual[idx], expected[idx]);
+    EXPECT_DOUBLE_EQ(memory()[idx], residual[idx]);
+  }
+}
@@ -42,6 +42,29 @@ TEST_F(EncoderIdentity, BlockCoordinate) {
     EXPECT_DOUBLE_EQ(actual[idx], expected[idx]);
 }
 
+TEST_F(EncoderIdentity, InPlace) {
+  std::vector<double> g(x);
+  const std::vector<int> block{0, 1, 6, 9};
+  result_type v;
+  operator()(g.data(), g.data() + g.size(), block.data(),
+             block.data() + block.size(), v);
+  v(std::begin(g), std::end(g));
+
+  const std::vector<double> expected{-5, 1, 0, 0, 0, 0, -100, 0, 0, -30};
+
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_DOUBLE_EQ(g[idx], expected[idx]);
+}
+
+TEST_F(EncoderIdentity, DecodeIntoSource) {
+  std::vector<double> g(x);
+  const auto v = operator()(g.data(), g.data() + g.size());
+  v(g.data(), g.data() + g.size());
+
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_DOUBLE_EQ(g[idx], x[idx]);
+}
+
 TEST_F(EncoderIdentity, Serialization) {
   std::vector<double> res1(x.size()), res2(x.size());
   const auto v1 = operator()(x.data(), x.data() + x.size());
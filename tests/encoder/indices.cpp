@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "polo/communicator/wire.hpp"
+#include "polo/encoder/indices.hpp"
+#include "gtest/gtest.h"
+
+template <class index_t> void roundtrip(const std::vector<index_t> &indices) {
+  const polo::encoder::detail::packed_indices<index_t> packed(indices);
+  const std::vector<index_t> decoded = packed.decode();
+  ASSERT_EQ(decoded.size(), indices.size());
+  for (size_t k = 0; k < indices.size(); k++)
+    EXPECT_EQ(decoded[k], indices[k]);
+  EXPECT_EQ(polo::encoder::detail::packed_indices<index_t>::size(indices),
+            polo::communicator::wire::size(packed));
+  for (std::size_t offset = 1; offset < 8; offset++) {
+    polo::communicator::wire::sizer sizer;
+    sizer(std::vector<std::uint8_t>(offset - 1), packed);
+    EXPECT_EQ(polo::encoder::detail::packed_indices<index_t>::size(
+                  indices, 8 + offset - 1),
+              sizer.size());
+  }
+}
+
+TEST(PackedIndices, Sparse) {
+  std::mt19937 gen;
+  std::bernoulli_distribution keep(0.01);
+  std::vector<int> indices;
+  for (int idx = 0; idx < 1000000; idx++)
+    if (keep(gen))
+      indices.push_back(idx);
+  roundtrip(indices);
+  EXPECT_LT(polo::encoder::detail::packed_indices<int>::size(indices),
+            sizeof(int) * indices.size() / 2);
+}
+
+TEST(PackedIndices, Dense) {
+  std::vector<int> indices;
+  for (int idx = 100; idx < 10000; idx += 2)
+    indices.push_back(idx);
+  roundtrip(indices);
+  EXPECT_LE(polo::encoder::detail::packed_indices<int>::size(indices),
+            32 + 9900 / 8 + 1);
+}
+
+TEST(PackedIndices, Unsorted) {
+  roundtrip(std::vector<int>{7, 3, 1000000, 0, 5, 5, -2});
+  roundtrip(std::vector<int>{});
+  roundtrip(std::vector<int>{42});
+}
+
+TEST(PackedIndices, Wide) {
+  roundtrip(std::vector<std::int64_t>{0, 1, std::int64_t{1} << 40,
+                                      (std::int64_t{1} << 40) + 3, 5});
+}
+
+TEST(PackedIndices, SliceBounds) {
+  const std::vector<int> indices{2, 3, 7, 11, 12, 40};
+  auto range = polo::encoder::detail::slice_bounds(indices, 3, 12);
+  EXPECT_EQ(range.first, 1u);
+  EXPECT_EQ(range.second, 4u);
+  range = polo::encoder::detail::slice_bounds(indices, 41, 50);
+  EXPECT_EQ(range.first, range.second);
+}
+
+template <unsigned int bits> void pack_codes() {
+  std::mt19937 gen;
+  std::uniform_int_distribution<int> code(0, (1 << bits) - 1);
+  std::uint8_t lanes[16], packed[2 * bits];
+  for (int trial = 0; trial < 100; trial++) {
+    for (auto &lane : lanes)
+      lane = std::uint8_t(code(gen));
+    polo::encoder::detail::pack_codes<bits>(lanes, packed);
+    for (unsigned int k = 0; k < 16; k++)
+      EXPECT_EQ((packed[k * bits / 8] >> (bits * k % 8)) & ((1 << bits) - 1),
+                lanes[k]);
+  }
+}
+
+TEST(PackedIndices, PackCodes) {
+  pack_codes<2>();
+  pack_codes<4>();
+  pack_codes<8>();
+}
+
+TEST(PackedIndices, SliceCodes) {
+  std::vector<std::uint8_t> codes(10);
+  std::mt19937 gen;
+  std::uniform_int_distribution<int> code(0, 2);
+  std::vector<int> values(40);
+  for (size_t k = 0; k < values.size(); k++) {
+    values[k] = code(gen);
+    codes[k / 4] |= std::uint8_t(values[k] << (2 * (k % 4)));
+  }
+  for (size_t first = 0; first < 12; first++)
+    for (size_t last = first; last <= values.size(); last += 3) {
+      const auto sliced =
+          polo::encoder::detail::slice_codes(codes, first, last);
+      ASSERT_EQ(sliced.size(), (last - first + 3) / 4);
+      for (size_t k = first; k < last; k++)
+        EXPECT_EQ((sliced[(k - first) / 4] >> (2 * ((k - first) % 4))) & 3,
+                  values[k]);
+      if (!sliced.empty() && (last - first) % 4 != 0) {
+        EXPECT_EQ(sliced.back() >> (2 * ((last - first) % 4)), 0);
+      }
+    }
+}
+
+// Packs the fields of packed_indices as they would arrive off the wire.
+struct forged {
+  std::uint8_t format;
+  std::uint64_t count;
+  std::int64_t base;
+  std::vector<std::uint8_t> bytes;
+
+  template <class Archive> void serialize(Archive &archive) {
+    archive(format, count, base, bytes);
+  }
+};
+
+polo::encoder::detail::packed_indices<int> receive(const forged &fields) {
+  std::vector<char> buffer(polo::communicator::wire::size(fields));
+  polo::communicator::wire::writer writer(buffer.data(), buffer.size());
+  writer(fields);
+  polo::encoder::detail::packed_indices<int> packed;
+  polo::communicator::wire::reader reader(buffer.data(), buffer.size());
+  reader(packed);
+  return packed;
+}
+
+TEST(PackedIndices, Forged) {
+  const auto packed = receive(forged{0, 2, 0, {0x00, 4, 2}});
+  EXPECT_EQ(packed.decode(), (std::vector<int>{2, 3}));
+}
+
+TEST(PackedIndices, Malformed) {
+  const std::vector<forged> inputs{
+      {2, 1, 0, {0xff}},                              // extra set bits
+      {2, 9, 0, {0xff}},                              // missing set bits
+      {0, 9, 0, {0, 0}},                              // short control
+      {0, 4, 0, {0xff, 1, 2, 3}},                     // short data
+      {1, 3, 0, {1, 2}},                              // missing varints
+      {1, 1, 0, {0x80, 0x80}},                        // open varint
+      {1, 1, 0, std::vector<std::uint8_t>(11, 0x80)}, // varint too long
+      {7, 0, 0, {}},                                  // unknown format
+  };
+  for (const auto &input : inputs) {
+    const auto packed = receive(input);
+    std::vector<int> indices;
+    EXPECT_THROW(packed.decode_into(indices), std::range_error);
+    EXPECT_THROW(packed.decode(), std::range_error);
+  }
+}
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cereal/archives/portable_binary.hpp"
+#include "polo/encoder/qsgd.hpp"
+#include "gtest/gtest.h"
+
+class EncoderQSGD : public polo::encoder::qsgd<double, int>,
+                    public ::testing::Test {
+protected:
+  EncoderQSGD() : x{-5, 1, 12, -7, 0, 0, -100, 500, 6, -30} {}
+  void SetUp() override {}
+  void TearDown() override {}
+  ~EncoderQSGD() override = default;
+
+  const std::vector<double> x;
+};
+
+TEST_F(EncoderQSGD, FullGradient) {
+  std::vector<double> actual(x.size());
+  const auto v = operator()(std::begin(x), std::end(x));
+  v(std::begin(actual), std::end(actual));
+
+  double l2norm = std::accumulate(
+      std::begin(x), std::end(x), double(0),
+      [](const double l2norm, const double val) { return l2norm + val * val; });
+  l2norm = std::sqrt(l2norm);
+
+  for (size_t idx = 0; idx < x.size(); idx++) {
+    const double level = actual[idx] / l2norm * levels();
+    EXPECT_NEAR(level, std::round(level), 1E-9);
+    EXPECT_LE(std::abs(actual[idx] - x[idx]), l2norm / levels() + 1E-9);
+    EXPECT_GE(actual[idx] * x[idx], 0);
+  }
+}
+
+TEST_F(EncoderQSGD, Unbiased) {
+  const size_t T{20000};
+  std::vector<double> mean(x.size()), actual(x.size());
+  for (size_t t = 0; t < T; t++) {
+    const auto v = operator()(std::begin(x), std::end(x));
+    v(std::begin(actual), std::end(actual));
+    for (size_t idx = 0; idx < x.size(); idx++)
+      mean[idx] += actual[idx] / T;
+  }
+
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_NEAR(mean[idx], x[idx], 1.0);
+}
+
+TEST_F(EncoderQSGD, Buckets) {
+  polo::encoder::qsgd<double, int, 2> coarse(1, 3);
+  polo::encoder::qsgd<double, int, 8> fine(100, 3);
+  std::vector<double> a(x.size()), b(x.size());
+  coarse(std::begin(x), std::end(x))(std::begin(a), std::end(a));
+  fine(std::begin(x), std::end(x))(std::begin(b), std::end(b));
+
+  for (size_t idx = 0; idx < x.size(); idx += 3) {
+    double l2norm{0};
+    for (size_t k = idx; k < std::min(idx + 3, x.size()); k++)
+      l2norm += x[k] * x[k];
+    l2norm = std::sqrt(l2norm);
+    for (size_t k = idx; k < std::min(idx + 3, x.size()); k++) {
+      EXPECT_TRUE(a[k] == 0 || std::abs(std::abs(a[k]) - l2norm) < 1E-9);
+      EXPECT_LE(std::abs(b[k] - x[k]), l2norm / 100 + 1E-9);
+    }
+  }
+}
+
+TEST_F(EncoderQSGD, BlockCoordinate) {
+  std::vector<double> actual(x.size());
+  const std::vector<int> block{0, 1, 6, 9};
+  const auto v = operator()(std::begin(x), std::end(x), std::begin(block),
+                            std::end(block));
+  v(std::begin(actual), std::end(actual));
+
+  double l2norm = std::accumulate(std::begin(block), std::end(block), double(0),
+                                  [&](const double l2norm, const int idx) {
+                                    const double val = x[idx];
+                                    return l2norm + val * val;
+                                  });
+  l2norm = std::sqrt(l2norm);
+
+  for (int idx = 0; idx < int(x.size()); idx++) {
+    if (std::find(std::begin(block), std::end(block), idx) == std::end(block)) {
+      EXPECT_DOUBLE_EQ(actual[idx], 0);
+    } else {
+      EXPECT_LE(std::abs(actual[idx] - x[idx]), l2norm / levels() + 1E-9);
+    }
+  }
+}
+
+TEST_F(EncoderQSGD, Serialization) {
+  std::vector<double> res1(x.size()), res2(x.size());
+  const auto v1 = operator()(std::begin(x), std::end(x));
+  v1(std::begin(res1), std::end(res1));
+
+  std::ostringstream oss{std::ios_base::binary};
+  {
+    cereal::PortableBinaryOutputArchive out{oss};
+    out(v1);
+  }
+  std::string serializeddata{oss.str()};
+
+  result_type v2;
+  std::istringstream iss{serializeddata, std::ios_base::binary};
+  {
+    cereal::PortableBinaryInputArchive in{iss};
+    in(v2);
+  }
+  v2(std::begin(res2), std::end(res2));
+
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_DOUBLE_EQ(res1[idx], res2[idx]);
+}
+
+TEST_F(EncoderQSGD, Slicing) {
+  polo::encoder::qsgd<double, int, 4> bucketed(7, 3);
+  const std::vector<int> block{0, 1, 2, 4, 6, 7, 9};
+  const std::vector<polo::encoder::qsgd<double, int, 4>::result_type> results{
+      operator()(std::begin(x), std::end(x)),
+      bucketed(std::begin(x), std::end(x)),
+      bucketed(std::begin(x), std::end(x), std::begin(block),
+               std::end(block))};
+
+  for (const auto &v1 : results) {
+    std::vector<double> expected(x.size());
+    v1(std::begin(expected), std::end(expected));
+
+    polo::encoder::qsgd<double, int, 4>::result_type part;
+    const size_t W{4};
+    const size_t split = x.size() / W;
+    const size_t remain = x.size() % W;
+    int indstart{0}, indend;
+    for (size_t w = 0; w < W; w++) {
+      const size_t ndata = (w < remain) ? split + 1 : split;
+      indend = indstart + ndata;
+      std::vector<double> actual(ndata);
+
+      const auto v = v1.slice(indstart, indend);
+      v(std::begin(actual), std::end(actual), indstart);
+
+      for (size_t idx = 0; idx < actual.size(); idx++)
+        EXPECT_DOUBLE_EQ(actual[idx], expected[idx + indstart]);
+
+      v1.slice(indstart, indend, part);
+      std::fill(std::begin(actual), std::end(actual), 0);
+      part(std::begin(actual), std::end(actual), indstart);
+      for (size_t idx = 0; idx < actual.size(); idx++)
+        EXPECT_DOUBLE_EQ(actual[idx], expected[idx + indstart]);
+
+      indstart = indend;
+    }
+  }
+}
+
+TEST(EncoderQSGDConst, Encode) {
+  const std::vector<double> x{-5, 1, 12, -7, 0, 0, -100, 500, 6, -30};
+  const std::vector<int> block{1, 3, 7};
+  const polo::encoder::qsgd<double, int> encoder;
+
+  std::vector<double> actual(x.size());
+  encoder(std::begin(x), std::end(x))(std::begin(actual), std::end(actual));
+  for (size_t idx = 0; idx < x.size(); idx++)
+    EXPECT_GE(actual[idx] * x[idx], 0);
+
+  std::fill(std::begin(actual), std::end(actual), 0);
+  encoder(std::begin(x), std::end(x), std::begin(block),
+          std::end(block))(std::begin(actual), std::end(actual));
+  for (int idx = 0; idx < int(x.size()); idx++)
+    if (std::find(std::begin(block), std::end(block), idx) == std::end(block)) {
+      EXPECT_EQ(actual[idx], 0);
+    }
+}
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cmath>
 #include <iterator>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -31,6 +34,22 @@ TEST_F(EncoderTopK, FullGradient) {
     EXPECT_DOUBLE_EQ(actual[idx], expected[idx]);
 }
 
+TEST_F(EncoderTopK, Reuse) {
+  std::vector<double> y(x);
+  std::reverse(std::begin(y), std::end(y));
+
+  result_type v;
+  for (const auto &z : {x, y, x}) {
+    std::vector<double> actual(z.size()), expected(z.size());
+    operator()(std::begin(z), std::end(z), v)(std::begin(actual),
+                                              std::end(actual));
+    operator()(std::begin(z), std::end(z))(std::begin(expected),
+                                           std::end(expected));
+    for (size_t idx = 0; idx < z.size(); idx++)
+      EXPECT_DOUBLE_EQ(actual[idx], expected[idx]);
+  }
+}
+
 TEST_F(EncoderTopK, BlockCoordinate) {
   std::vector<double> actual(x.size());
   const std::vector<int> block{0, 1, 6, 9};
@@ -73,6 +92,7 @@ TEST_F(EncoderTopK, Slicing) {
   const auto v1 = operator()(std::begin(x), std::end(x));
   v1(std::begin(expected), std::end(expected));
 
+  result_type part;
   const size_t W{4};
   const size_t split = x.size() / W;
   const size_t remain = x.size() % W;
@@ -85,9 +105,78 @@ TEST_F(EncoderTopK, Slicing) {
     const auto v = v1.slice(indstart, indend);
     v(std::begin(actual), std::end(actual), indstart);
 
+    for (size_t idx = 0; idx < actual.size(); idx++)
+      EXPECT_DOUBLE_EQ(actual[idx], expected[idx + indstart]);
+
+    v1.slice(indstart, indend, part);
+    std::fill(std::begin(actual), std::end(actual), 0);
+    part(std::begin(actual), std::end(actual), indstart);
     for (size_t idx = 0; idx < actual.size(); idx++)
       EXPECT_DOUBLE_EQ(actual[idx], expected[idx + indstart]);
 
     indstart = indend;
   }
 }
+
+TEST(EncoderTopKSelection, Exact) {
+  std::mt19937 gen;
+  std::normal_distribution<double> dist;
+  std::vector<double> x(1 << 18);
+  for (double &val : x)
+    val = std::round(100 * dist(gen));
+
+  polo::encoder::topk<double, int> heap(100, polo::encoder::selection::heap);
+  polo::encoder::topk<double, int> exact(100, polo::encoder::selection::exact);
+  polo::encoder::topk<double, int> chunked(100,
+                                           polo::encoder::selection::chunked);
+  chunked.threads(4);
+
+  std::vector<double> expected(x.size()), actual(x.size());
+  heap(std::begin(x), std::end(x))(std::begin(expected), std::end(expected));
+
+  for (auto *encoder : {&exact, &chunked}) {
+    const auto v = (*encoder)(std::begin(x), std::end(x));
+    v(std::begin(actual), std::end(actual));
+    double kept{0};
+    int k{0};
+    for (size_t idx = 0; idx < x.size(); idx++) {
+      kept += std::abs(actual[idx]) - std::abs(expected[idx]);
+      k += actual[idx] != 0;
+    }
+    EXPECT_DOUBLE_EQ(kept, 0);
+    EXPECT_EQ(k, 100);
+  }
+
+  std::vector<double> again(x.size());
+  chunked(std::begin(x), std::end(x))(std::begin(actual), std::end(actual));
+  chunked(std::begin(x), std::end(x))(std::begin(again), std::end(again));
+  EXPECT_EQ(actual, again);
+}
+
+TEST(EncoderTopKSelection, Sampled) {
+  std::mt19937 gen;
+  std::normal_distribution<double> dist;
+  std::vector<double> x(1 << 18);
+  for (double &val : x)
+    val = dist(gen);
+
+  polo::encoder::topk<double, int> sampled(1000,
+                                           polo::encoder::selection::sampled);
+  std::vector<double> actual(x.size());
+  const auto v = sampled(std::begin(x), std::end(x));
+  v(std::begin(actual), std::end(actual));
+
+  double smallest{1E10}, largest{0};
+  size_t k{0};
+  for (size_t idx = 0; idx < x.size(); idx++)
+    if (actual[idx] != 0) {
+      EXPECT_DOUBLE_EQ(actual[idx], x[idx]);
+      smallest = std::min(smallest, std::abs(x[idx]));
+      k++;
+    } else
+      largest = std::max(largest, std::abs(x[idx]));
+
+  EXPECT_LT(largest, smallest);
+  EXPECT_GT(k, 700);
+  EXPECT_LT(k, 1300);
+}
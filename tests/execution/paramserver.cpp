@@ -0,0 +1,721 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "polo/polo.hpp"
+#include "gtest/gtest.h"
+
+using namespace polo;
+using namespace polo::execution::paramserver;
+
+template <template <class, class> class execution>
+using algorithm_t =
+    algorithm::proxgradient<double, int, boosting::none, step::constant,
+                            smoothing::none, prox::none, execution>;
+
+const int dimension{12};
+const double stepsize{0.25};
+
+// 0.5 * sum_r (x_r - r - 1)^2, with one row per coordinate so that a
+// minibatch of rows touches only the coordinates of those rows.
+struct separable {
+  struct rows {
+    std::vector<int> colindices(const int row) const { return {row}; }
+  };
+
+  double operator()(const double *x, double *g) const {
+    double fval{0};
+    for (int idx = 0; idx < dimension; idx++) {
+      g[idx] = x[idx] - idx - 1;
+      fval += 0.5 * g[idx] * g[idx];
+    }
+    return fval;
+  }
+  double operator()(const double *x, double *g, const int *rb,
+                    const int *re) const {
+    double fval{0};
+    std::fill(g, g + dimension, 0);
+    for (; rb != re; ++rb) {
+      g[*rb] = x[*rb] - *rb - 1;
+      fval += 0.5 * g[*rb] * g[*rb];
+    }
+    return fval;
+  }
+  const rows *matrix() const { return &data; }
+
+  rows data;
+};
+
+std::vector<double> serial(const int iterations) {
+  algorithm_t<execution::serial> alg;
+  alg.step_parameters(stepsize);
+  alg.initialize(std::vector<double>(dimension));
+  alg.solve(separable{}, utility::detail::null{},
+            terminator::iteration<double, int>{iterations});
+  return alg.getx();
+}
+
+// Every role of a test runs on its own thread and talks over inproc.
+options local(const int masters) {
+  const std::string name =
+      ::testing::UnitTest::GetInstance()->current_test_info()->name();
+  options opts;
+  opts.num_masters(masters);
+  opts.scheduler("inproc://" + name + "-scheduler", 1, 2, 3);
+  opts.master("inproc://" + name + "-master", 1);
+  opts.context(communicator::zmq::context{});
+  opts.linger(0);
+  opts.timeout(2000);
+  opts.gossip_interval(1);
+  return opts;
+}
+
+struct outcome {
+  std::vector<std::vector<double>> x;
+  int k;
+  std::vector<scheduler<double, int>::load> loads;
+};
+
+// Runs a scheduler until its iteration count passes iterations, the masters
+// and aggregator that opts asks for, and workers that each call solve with
+// their algorithm and the loss. Returns the last iterate of every worker.
+template <class Solve, class Encoder = encoder::identity<double, int>>
+outcome run(const options &opts, const int iterations, const int workers,
+            Solve &&solve, Encoder encoder = {}) {
+  outcome result{std::vector<std::vector<double>>(workers), 0, {}};
+  const std::vector<double> x0(dimension);
+  const separable loss;
+
+  std::mutex sync;
+  std::vector<std::string> failures;
+  auto guard = [&](const std::function<void()> &f) {
+    try {
+      f();
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(sync);
+      failures.push_back(e.what());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.emplace_back([&]() {
+    guard([&]() {
+      algorithm_t<scheduler> alg;
+      alg.execution_parameters(opts);
+      alg.initialize(x0);
+      auto terminate = [&](const int k, const double, const double *,
+                           const double *, const double *) {
+        result.k = k;
+        return k > iterations;
+      };
+      alg.solve(loss, utility::detail::null{}, terminate, encoder);
+      result.loads = alg.loads();
+    });
+  });
+  for (int m = 0; m < opts.num_masters(); m++)
+    threads.emplace_back([&]() {
+      guard([&]() {
+        algorithm_t<master> alg;
+        alg.execution_parameters(opts);
+        alg.step_parameters(stepsize);
+        alg.initialize(x0);
+        alg.solve(loss, utility::detail::null{},
+                  terminator::iteration<double, int>{iterations}, encoder);
+      });
+    });
+  if (!opts.aggregator().first.empty())
+    threads.emplace_back([&]() {
+      guard([&]() {
+        algorithm_t<aggregator> alg;
+        alg.execution_parameters(opts);
+        alg.initialize(x0);
+        alg.solve(loss, utility::detail::null{},
+                  terminator::iteration<double, int>{iterations}, encoder);
+      });
+    });
+  for (int w = 0; w < workers; w++)
+    threads.emplace_back([&, w]() {
+      guard([&]() {
+        algorithm_t<worker> alg;
+        alg.execution_parameters(opts);
+        alg.step_parameters(stepsize);
+        alg.initialize(x0);
+        solve(alg, loss, encoder);
+        result.x[w] = alg.getx();
+      });
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  for (const auto &failure : failures)
+    ADD_FAILURE() << failure;
+  return result;
+}
+
+auto dense = [](algorithm_t<worker> &alg, const separable &loss,
+                const encoder::identity<double, int> &encoder) {
+  alg.solve(loss, utility::detail::null{},
+            terminator::iteration<double, int>{0}, encoder);
+};
+
+void expect_near(const outcome &result, const std::vector<double> &expected,
+                 const double tolerance) {
+  for (const auto &x : result.x) {
+    ASSERT_EQ(x.size(), expected.size());
+    for (int idx = 0; idx < dimension; idx++)
+      EXPECT_NEAR(x[idx], expected[idx], tolerance) << "at " << idx;
+  }
+}
+
+TEST(Paramserver, SingleMaster) {
+  const auto result = run(local(1), 200, 1, dense);
+  expect_near(result, serial(200), 1e-9);
+  EXPECT_GT(result.k, 200);
+}
+
+TEST(Paramserver, ManyMasters) {
+  const auto result = run(local(3), 200, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+  ASSERT_EQ(result.loads.size(), 3u);
+  for (const auto &load : result.loads)
+    EXPECT_EQ(load.end - load.start, dimension / 3);
+}
+
+TEST(Paramserver, Decentralized) {
+  options opts = local(2);
+  opts.decentralized(true);
+  const auto result = run(opts, 400, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+}
+
+// Each push touches one coordinate and so reaches one master. The count must
+// follow the pushes, not the busiest master.
+TEST(Paramserver, DecentralizedCount) {
+  options opts = local(2);
+  opts.decentralized(true);
+  std::atomic<int> gradients{0};
+  auto sparse = [&](algorithm_t<worker> &alg, const separable &loss,
+                    const encoder::identity<double, int> &encoder) {
+    auto counted = [&](const double *x, double *g) {
+      gradients++;
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      return loss(x, g);
+    };
+    utility::sampler::uniform<int> sampler;
+    sampler.parameters(0, dimension - 1);
+    alg.solve(counted, utility::sampler::coordinate, sampler, 1,
+              utility::detail::null{}, terminator::iteration<double, int>{0},
+              encoder);
+  };
+  const auto result = run(opts, 200, 1, sparse);
+  EXPECT_GT(result.k, 200);
+  EXPECT_LE(result.k - 1, gradients);
+  EXPECT_GE(result.k - 1, gradients - 40);
+}
+
+TEST(Paramserver, PipelineDepth) {
+  options opts = local(2);
+  opts.pipeline_depth(3);
+  const auto result = run(opts, 300, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+  EXPECT_GT(result.k, 300);
+}
+
+// Workers keep up through published deltas and pull only to catch up.
+TEST(Paramserver, Broadcast) {
+  options opts = local(2);
+  opts.broadcast_interval(2);
+  const auto result = run(opts, 300, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+  for (const auto &load : result.loads)
+    EXPECT_LT(load.pulls, load.pushes);
+}
+
+// The serialized slice is cached between updates, so every pull must still
+// see the update of the push before it.
+TEST(Paramserver, PullsSeeEveryUpdate) {
+  std::vector<double> seen, expected;
+  auto recording = [](std::vector<double> &values) {
+    return [&values](const double *x, double *g) {
+      values.push_back(x[dimension - 1]);
+      return separable{}(x, g);
+    };
+  };
+
+  algorithm_t<execution::serial> alg;
+  alg.step_parameters(stepsize);
+  alg.initialize(std::vector<double>(dimension));
+  alg.solve(recording(expected), utility::detail::null{},
+            terminator::iteration<double, int>{50});
+
+  run(local(1), 50, 1,
+      [&](algorithm_t<worker> &alg, const separable &,
+          const encoder::identity<double, int> &encoder) {
+        alg.solve(recording(seen), utility::detail::null{},
+                  terminator::iteration<double, int>{0}, encoder);
+      });
+  ASSERT_GE(seen.size(), 50u);
+  for (std::size_t k = 0; k < 50; k++)
+    EXPECT_DOUBLE_EQ(seen[k], expected[k]) << "at iteration " << k;
+}
+
+// Runs a scheduler until finished is set, for tests that stand in for the
+// workers themselves.
+std::thread schedule(const options &opts, const std::vector<double> &x0,
+                     const std::atomic<bool> &finished) {
+  return std::thread([&opts, &x0, &finished]() {
+    try {
+      algorithm_t<scheduler> alg;
+      alg.execution_parameters(opts);
+      alg.initialize(x0);
+      alg.solve(separable{}, utility::detail::null{},
+                [&](const int, const double, const double *, const double *,
+                    const double *) { return finished.load(); },
+                encoder::identity<double, int>{});
+    } catch (const std::exception &e) {
+      ADD_FAILURE() << e.what();
+    }
+  });
+}
+
+// The worker's side of the wire, driven by hand. Talks to the first master
+// unless given another endpoint.
+struct peer {
+  explicit peer(const options &opts, std::string endpoint = {})
+      : dealer{opts.context(), communicator::zmq::socket_type::dealer} {
+    if (endpoint.empty())
+      endpoint = detail::endpoint(opts.master().first, opts.master().second);
+    dealer.set(communicator::zmq::socket_opt::linger, 0);
+    dealer.connect(endpoint.c_str());
+    poll.additem(dealer, communicator::zmq::poll_event::pollin);
+  }
+
+  void push(const std::uint32_t seq, const std::vector<double> &g) {
+    msg.clear();
+    msg.addpart(seq);
+    msg.addpart();
+    msg.addpart('g');
+    msg.addpart(detail::serialize(0));
+    msg.addpart(detail::serialize(1));
+    msg.addpart(detail::serialize(0.0));
+    msg.addpart(detail::serialize(1));
+    msg.addpart(detail::serialize(
+        encoder::identity<double, int>::result_type(std::vector<double>(g))));
+    msg.send(dealer);
+  }
+
+  bool pull(const std::uint32_t seq, std::vector<double> &x) {
+    msg.clear();
+    msg.addpart(seq);
+    msg.addpart();
+    msg.addpart('x');
+    msg.addpart();
+    msg.send(dealer);
+    if (!reply(seq))
+      return false;
+    detail::deserialize(msg, 3, x);
+    return true;
+  }
+
+  // Waits for the reply to seq and leaves it in msg.
+  bool reply(const std::uint32_t seq) {
+    if (poll.poll(1000) == 0)
+      return false;
+    msg.receive(dealer);
+    return msg.read<std::uint32_t>(0) == seq;
+  }
+
+  bool acked(const std::uint32_t seq) {
+    return reply(seq) && msg.numparts() == 4 && msg.size(3) == 0;
+  }
+
+  // Sends a push cut short after its iteration count and returns the reason
+  // it was rejected for, or nothing if it was not.
+  std::string truncated(const std::uint32_t seq) {
+    msg.clear();
+    msg.addpart(seq);
+    msg.addpart();
+    msg.addpart('g');
+    msg.addpart(detail::serialize(0));
+    msg.addpart(detail::serialize(1));
+    msg.send(dealer);
+    if (!reply(seq) || msg.numparts() != 5 || msg.size(3) != 0)
+      return {};
+    return msg.read(4);
+  }
+
+  communicator::zmq::socket dealer;
+  communicator::zmq::poller poll;
+  communicator::zmq::message msg;
+};
+
+std::atomic<bool> entered{false}, released{false};
+
+// Holds every update until released, to see what pulls get meanwhile.
+template <class value_t, class index_t>
+struct held : step::constant<value_t, index_t> {
+  template <class InputIt1, class InputIt2>
+  value_t step(const index_t klocal, const index_t kglobal, const value_t fval,
+               InputIt1 xbegin, InputIt1 xend, InputIt2 gbegin) const {
+    entered = true;
+    while (!released)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return step::constant<value_t, index_t>::step(klocal, kglobal, fval, xbegin,
+                                                  xend, gbegin);
+  }
+};
+
+TEST(Paramserver, PullsDuringUpdate) {
+  options opts = local(1);
+  opts.master_threads(2);
+  const std::vector<double> x0(dimension, 1);
+
+  std::atomic<bool> finished{false};
+  std::thread scheduling = schedule(opts, x0, finished);
+  std::thread serving([&]() {
+    try {
+      algorithm::proxgradient<double, int, boosting::none, held,
+                              smoothing::none, prox::none, master>
+          alg;
+      alg.execution_parameters(opts);
+      alg.step_parameters(stepsize);
+      alg.initialize(x0);
+      alg.solve(separable{}, utility::detail::null{},
+                terminator::iteration<double, int>{0},
+                encoder::identity<double, int>{});
+    } catch (const std::exception &e) {
+      ADD_FAILURE() << e.what();
+    }
+  });
+
+  peer worker(opts);
+  std::vector<double> x;
+  worker.push(1, x0);
+  while (!entered)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_TRUE(worker.pull(2, x)) << "pull waited for the update";
+  EXPECT_EQ(x, x0);
+
+  released = true;
+  EXPECT_TRUE(worker.acked(1));
+  EXPECT_TRUE(worker.pull(3, x));
+  EXPECT_EQ(x, std::vector<double>(dimension, 1 - stepsize));
+
+  finished = true;
+  scheduling.join();
+  serving.join();
+}
+
+TEST(Paramserver, AggregationWindow) {
+  options opts = local(2);
+  opts.aggregation_count(2);
+  const auto result = run(opts, 300, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+}
+
+// Gradients of a window that never fills are applied when the master stops.
+TEST(Paramserver, PartialWindow) {
+  options opts = local(1);
+  opts.aggregation_count(3);
+  const std::vector<double> x0(dimension, 1);
+
+  std::atomic<bool> finished{false};
+  std::thread scheduling = schedule(opts, x0, finished);
+  std::vector<double> x;
+  std::thread serving([&]() {
+    try {
+      algorithm_t<master> alg;
+      alg.execution_parameters(opts);
+      alg.step_parameters(stepsize);
+      alg.initialize(x0);
+      alg.solve(separable{}, utility::detail::null{},
+                terminator::iteration<double, int>{0},
+                encoder::identity<double, int>{});
+      x = alg.getx();
+    } catch (const std::exception &e) {
+      ADD_FAILURE() << e.what();
+    }
+  });
+
+  peer worker(opts);
+  worker.push(1, x0);
+  EXPECT_TRUE(worker.acked(1));
+  finished = true;
+  scheduling.join();
+  serving.join();
+  EXPECT_EQ(x, std::vector<double>(dimension, 1 - stepsize));
+}
+
+TEST(Paramserver, MalformedPush) {
+  options opts = local(1);
+  const std::vector<double> x0(dimension, 1);
+
+  std::atomic<bool> finished{false};
+  std::thread scheduling = schedule(opts, x0, finished);
+  std::vector<double> x;
+  std::thread serving([&]() {
+    try {
+      algorithm_t<master> alg;
+      alg.execution_parameters(opts);
+      alg.step_parameters(stepsize);
+      alg.initialize(x0);
+      alg.solve(separable{}, utility::detail::null{},
+                terminator::iteration<double, int>{0},
+                encoder::identity<double, int>{});
+      x = alg.getx();
+    } catch (const std::exception &e) {
+      ADD_FAILURE() << e.what();
+    }
+  });
+
+  peer worker(opts);
+  EXPECT_FALSE(worker.truncated(1).empty());
+  worker.push(2, x0);
+  EXPECT_TRUE(worker.acked(2)) << "master stopped serving";
+  finished = true;
+  scheduling.join();
+  serving.join();
+  EXPECT_EQ(x, std::vector<double>(dimension, 1 - stepsize));
+}
+
+options aggregated(const int masters, const int workers) {
+  options opts = local(masters);
+  const std::string name =
+      ::testing::UnitTest::GetInstance()->current_test_info()->name();
+  opts.aggregator("inproc://" + name + "-aggregator", workers);
+  return opts;
+}
+
+TEST(Paramserver, Aggregator) {
+  const auto result = run(aggregated(2, 2), 600, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+}
+
+// An aggregator's push stands for all the gradients in its window.
+TEST(Paramserver, AggregatorCount) {
+  options opts = aggregated(2, 2);
+  opts.decentralized(true);
+  std::atomic<int> gradients{0};
+  auto counting = [&](algorithm_t<worker> &alg, const separable &loss,
+                      const encoder::identity<double, int> &encoder) {
+    auto counted = [&](const double *x, double *g) {
+      gradients++;
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      return loss(x, g);
+    };
+    alg.solve(counted, utility::detail::null{},
+              terminator::iteration<double, int>{0}, encoder);
+  };
+  const auto result = run(opts, 200, 1, counting);
+  EXPECT_GT(result.k, 200);
+  EXPECT_LE(result.k - 1, gradients);
+  EXPECT_GE(result.k - 1, gradients - 40);
+}
+
+// Masters see the mean of a window, unencoded, as one push.
+TEST(Paramserver, AggregatorForwardsMean) {
+  options opts = aggregated(1, 2);
+  opts.aggregation_time(5);
+  const std::vector<double> x0(dimension, 1);
+
+  std::atomic<bool> finished{false};
+  std::thread scheduling = schedule(opts, x0, finished);
+  std::thread serving([&]() {
+    try {
+      algorithm_t<master> alg;
+      alg.execution_parameters(opts);
+      alg.step_parameters(stepsize);
+      alg.initialize(x0);
+      alg.solve(separable{}, utility::detail::null{},
+                terminator::iteration<double, int>{0},
+                encoder::identity<double, int>{});
+    } catch (const std::exception &e) {
+      ADD_FAILURE() << e.what();
+    }
+  });
+  std::thread aggregating([&]() {
+    try {
+      algorithm_t<aggregator> alg;
+      alg.execution_parameters(opts);
+      alg.initialize(x0);
+      alg.solve(separable{}, utility::detail::null{},
+                terminator::iteration<double, int>{0},
+                encoder::identity<double, int>{});
+    } catch (const std::exception &e) {
+      ADD_FAILURE() << e.what();
+    }
+  });
+
+  peer worker(opts, opts.aggregator().first), observer(opts);
+  EXPECT_FALSE(worker.truncated(1).empty());
+  worker.push(2, x0);
+  EXPECT_TRUE(worker.acked(2));
+  worker.push(3, std::vector<double>(dimension, 3));
+  EXPECT_TRUE(worker.acked(3));
+
+  const std::vector<double> expected(dimension, 1 - 2 * stepsize);
+  std::vector<double> x;
+  for (std::uint32_t seq = 1; seq < 1000 && x != expected; seq++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_TRUE(observer.pull(seq, x));
+  }
+  EXPECT_EQ(x, expected);
+
+  // Aggregated pushes carry plain values, which must fill the whole shard.
+  observer.msg.clear();
+  observer.msg.addpart(std::uint32_t{1000});
+  observer.msg.addpart();
+  observer.msg.addpart('a');
+  observer.msg.addpart(detail::serialize(0));
+  observer.msg.addpart(detail::serialize(1));
+  observer.msg.addpart(detail::serialize(0.0));
+  observer.msg.addpart(detail::serialize(1));
+  observer.msg.addpart(detail::serialize(1));
+  observer.msg.addpart(
+      detail::serialize(std::vector<double>(dimension - 1, 1)));
+  observer.msg.send(observer.dealer);
+  EXPECT_TRUE(observer.reply(1000));
+  EXPECT_EQ(observer.msg.numparts(), 5u);
+
+  finished = true;
+  scheduling.join();
+  serving.join();
+  aggregating.join();
+}
+
+void partitioned(options opts) {
+  const auto result = run(opts, 300, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+  ASSERT_EQ(result.loads.size(), 3u);
+  int owned{0};
+  for (const auto &load : result.loads) {
+    owned += load.end - load.start;
+    EXPECT_GT(load.pushes, 0u);
+  }
+  EXPECT_EQ(owned, dimension);
+}
+
+TEST(Paramserver, StridedPartition) {
+  options opts = local(3);
+  opts.partition(layout::strided);
+  partitioned(opts);
+}
+
+TEST(Paramserver, HashedPartition) {
+  options opts = local(3);
+  opts.partition(layout::hashed);
+  partitioned(opts);
+}
+
+TEST(Paramserver, WeightedPartition) {
+  options opts = local(3);
+  std::vector<double> weights(dimension, 1);
+  weights[0] = weights[1] = dimension;
+  opts.partition(weights);
+  partitioned(opts);
+}
+
+// Minibatches of rows, each of which touches one coordinate, so that sparse
+// pulls ask every master for a few coordinates at most.
+auto minibatch = [](algorithm_t<worker> &alg, const separable &loss,
+                    const encoder::identity<double, int> &encoder) {
+  utility::sampler::uniform<int> sampler;
+  sampler.parameters(0, dimension - 1);
+  alg.solve(loss, utility::sampler::component, sampler, 3,
+            utility::detail::null{}, terminator::iteration<double, int>{0},
+            encoder);
+};
+
+TEST(Paramserver, SparsePulls) {
+  options opts = local(2);
+  opts.sparse_pulls(true);
+  const auto result = run(opts, 1000, 2, minibatch);
+  expect_near(result, serial(200), 1e-6);
+}
+
+TEST(Paramserver, SparsePullsStrided) {
+  options opts = local(3);
+  opts.sparse_pulls(true);
+  opts.partition(layout::strided);
+  const auto result = run(opts, 1000, 2, minibatch);
+  expect_near(result, serial(200), 1e-6);
+}
+
+TEST(Paramserver, LocalSteps) {
+  options opts = local(2);
+  opts.local_steps(4);
+  opts.aggregation_count(2);
+  const auto result = run(opts, 200, 2, dense);
+  expect_near(result, serial(200), 1e-6);
+}
+
+// Changes from local steps are averaged over the workers behind each push,
+// so an aggregator's push weighs as much as the workers it stands for.
+TEST(Paramserver, LocalStepsAverage) {
+  options opts = local(1);
+  opts.local_steps(4);
+  opts.aggregation_count(3);
+  const std::vector<double> x0(dimension, 1);
+
+  std::atomic<bool> finished{false};
+  std::thread scheduling = schedule(opts, x0, finished);
+  std::thread serving([&]() {
+    try {
+      algorithm_t<master> alg;
+      alg.execution_parameters(opts);
+      alg.step_parameters(stepsize);
+      alg.initialize(x0);
+      alg.solve(separable{}, utility::detail::null{},
+                terminator::iteration<double, int>{0},
+                encoder::identity<double, int>{});
+    } catch (const std::exception &e) {
+      ADD_FAILURE() << e.what();
+    }
+  });
+
+  peer worker(opts);
+  worker.push(1, std::vector<double>(dimension, 3));
+  EXPECT_TRUE(worker.acked(1));
+  worker.msg.clear();
+  worker.msg.addpart(std::uint32_t{2});
+  worker.msg.addpart();
+  worker.msg.addpart('a');
+  worker.msg.addpart(detail::serialize(0));
+  worker.msg.addpart(detail::serialize(1));
+  worker.msg.addpart(detail::serialize(0.0));
+  worker.msg.addpart(detail::serialize(2));
+  worker.msg.addpart(detail::serialize(2));
+  worker.msg.addpart(detail::serialize(std::vector<double>(dimension)));
+  worker.msg.send(worker.dealer);
+  EXPECT_TRUE(worker.acked(2));
+
+  std::vector<double> x;
+  EXPECT_TRUE(worker.pull(3, x));
+  EXPECT_EQ(x, std::vector<double>(dimension));
+
+  finished = true;
+  scheduling.join();
+  serving.join();
+}
+
+TEST(Paramserver, SparsePullsNeedOneStep) {
+  options opts = local(1);
+  opts.sparse_pulls(true);
+  opts.local_steps(2);
+  algorithm_t<worker> alg;
+  EXPECT_THROW(alg.execution_parameters(opts), std::domain_error);
+  opts.local_steps(1);
+  opts.pipeline_depth(2);
+  EXPECT_THROW(alg.execution_parameters(opts), std::domain_error);
+  opts.pipeline_depth(1);
+  opts.broadcast_interval(2);
+  EXPECT_THROW(alg.execution_parameters(opts), std::domain_error);
+  opts.broadcast_interval(0);
+  EXPECT_NO_THROW(alg.execution_parameters(opts));
+}
@@ -0,0 +1,115 @@
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "polo/polo.hpp"
+#include "gtest/gtest.h"
+
+using namespace polo;
+
+using ring_t =
+    algorithm::proxgradient<double, int, boosting::none, step::constant,
+                            smoothing::none, prox::none,
+                            execution::ring::allreduce>;
+
+std::vector<std::string> inproc(const int nranks) {
+  const std::string name =
+      ::testing::UnitTest::GetInstance()->current_test_info()->name();
+  std::vector<std::string> peers;
+  for (int rank = 0; rank < nranks; rank++)
+    peers.push_back("inproc://ring-" + name + "-" + std::to_string(rank));
+  return peers;
+}
+
+// Ports that the system hands out as free, released again when the context
+// that bound them closes on return.
+std::vector<std::string> localhost(const int nranks) {
+  const communicator::zmq::context ctx;
+  std::vector<communicator::zmq::socket> sockets;
+  std::vector<std::string> peers;
+  for (int rank = 0; rank < nranks; rank++) {
+    sockets.emplace_back(ctx, communicator::zmq::socket_type::router);
+    sockets.back().set(communicator::zmq::socket_opt::linger, 0);
+    sockets.back().bind("tcp://127.0.0.1:*");
+    char endpoint[256];
+    sockets.back().get(communicator::zmq::socket_opt::last_endpoint,
+                       endpoint);
+    peers.emplace_back(endpoint);
+  }
+  return peers;
+}
+
+// Every rank minimizes 0.5 * ||x - a_r||^2 on its own target a_r, so the
+// averaged gradient drives all replicas to the mean of the targets.
+void run(const std::vector<std::string> &peers, const int dimension,
+         const int chunks) {
+  const int nranks = peers.size();
+  // Ranks on inproc share a context as they would within one process; the
+  // others each keep their own, as separate processes do.
+  const bool shared = peers.front().compare(0, 9, "inproc://") == 0;
+  const communicator::zmq::context ctx;
+
+  std::vector<std::vector<double>> targets(nranks);
+  std::vector<double> mean(dimension);
+  for (int rank = 0; rank < nranks; rank++) {
+    for (int idx = 0; idx < dimension; idx++) {
+      targets[rank].push_back(rank * dimension + idx);
+      mean[idx] += targets[rank].back() / nranks;
+    }
+  }
+
+  std::vector<std::vector<double>> solutions(nranks);
+  std::vector<double> losses(nranks);
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < nranks; rank++)
+    threads.emplace_back([&, rank]() {
+      execution::ring::options opts;
+      opts.peers(peers);
+      opts.rank(rank);
+      opts.chunks(chunks);
+      if (shared)
+        opts.context(ctx);
+
+      ring_t alg;
+      alg.step_parameters(0.5);
+      alg.execution_parameters(opts);
+      alg.initialize(std::vector<double>(dimension));
+
+      const std::vector<double> &a = targets[rank];
+      auto loss = [&](const double *x, double *g) {
+        double fval{0};
+        for (int idx = 0; idx < dimension; idx++) {
+          g[idx] = x[idx] - a[idx];
+          fval += 0.5 * g[idx] * g[idx];
+        }
+        return fval;
+      };
+      alg.solve(loss, utility::detail::null{},
+                terminator::iteration<double, int>{60});
+      solutions[rank] = alg.getx();
+      losses[rank] = alg.getf();
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  for (int rank = 0; rank < nranks; rank++) {
+    ASSERT_EQ(solutions[rank].size(), std::size_t(dimension));
+    EXPECT_DOUBLE_EQ(losses[rank], losses[0]);
+    for (int idx = 0; idx < dimension; idx++) {
+      EXPECT_DOUBLE_EQ(solutions[rank][idx], solutions[0][idx]);
+      EXPECT_NEAR(solutions[rank][idx], mean[idx], 1e-9);
+    }
+  }
+}
+
+TEST(Ring, SingleRank) { run(inproc(1), 10, 4); }
+
+TEST(Ring, Allreduce) { run(inproc(4), 1000, 4); }
+
+TEST(Ring, UnevenSegments) { run(inproc(3), 7, 3); }
+
+TEST(Ring, MoreRanksThanCoordinates) { run(inproc(5), 2, 2); }
+
+TEST(Ring, Tcp) { run(localhost(3), 100, 4); }
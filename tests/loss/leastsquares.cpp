@@ -92,3 +92,68 @@ TEST_F(LeastSquares, Incremental) {
   for (int idx = 0; idx < 3; idx++)
     EXPECT_DOUBLE_EQ(g[idx], g_expected[idx]);
 }
+
+TEST_F(LeastSquares, Weighted) {
+  const int nrows{3};
+  const int ncols{3};
+  const std::vector<double> x{8, 9, 10};
+  const std::vector<double> b{5, 6, 7};
+
+  const std::vector<int> indices{0, 2};
+  const std::vector<double> w{2, 0.5};
+
+  const std::vector<int> row_ptr{0, 2, 3, 4};
+  const std::vector<int> cols{0, 2, 1, 2};
+  const std::vector<double> nzvals{1, 2, 3, 4};
+  polo::matrix::smatrix<double, int> smat(nrows, ncols, row_ptr, cols, nzvals);
+  data(polo::loss::data<double, int>(smat, b));
+
+  std::vector<double> g_expected(x.size()), gi(x.size());
+  double fval_expected{0};
+  for (std::size_t k = 0; k < indices.size(); k++) {
+    fval_expected +=
+        w[k] * operator()(x.data(), gi.data(), &indices[k], &indices[k] + 1);
+    for (int idx = 0; idx < 3; idx++)
+      g_expected[idx] += w[k] * gi[idx];
+  }
+
+  std::vector<double> g(x.size());
+  double fval = operator()(x.data(), g.data(), indices.data(),
+                           indices.data() + indices.size(), w.data());
+
+  EXPECT_DOUBLE_EQ(fval, fval_expected);
+  for (int idx = 0; idx < 3; idx++)
+    EXPECT_DOUBLE_EQ(g[idx], g_expected[idx]);
+
+  fval = polo::loss::aloss<double, int>::operator()(
+      x.data(), g.data(), indices.data(), indices.data() + indices.size(),
+      w.data());
+
+  EXPECT_DOUBLE_EQ(fval, fval_expected);
+  for (int idx = 0; idx < 3; idx++)
+    EXPECT_DOUBLE_EQ(g[idx], g_expected[idx]);
+}
+
+TEST(LeastSquaresObject, Weighted) {
+  const std::vector<double> x{8, 9, 10};
+  const std::vector<double> b{5, 6, 7};
+  const std::vector<int> indices{0, 2};
+  const std::vector<double> w{2, 0.5};
+
+  polo::matrix::dmatrix<double, int> dmat(3, 3, {1, 0, 0, 0, 3, 0, 2, 0, 4});
+  const polo::loss::leastsquares<double, int> loss(
+      polo::loss::data<double, int>(dmat, b));
+  const polo::loss::aloss<double, int> &base = loss;
+
+  std::vector<double> g_expected(x.size()), g(x.size());
+  const double fval_expected =
+      base(x.data(), g_expected.data(), indices.data(),
+           indices.data() + indices.size(), w.data());
+  const double fval = loss(x.data(), g.data(), indices.data(),
+                           indices.data() + indices.size(), w.data());
+
+  EXPECT_DOUBLE_EQ(fval, 2 * 264.5 + 0.5 * 544.5);
+  EXPECT_DOUBLE_EQ(fval, fval_expected);
+  for (int idx = 0; idx < 3; idx++)
+    EXPECT_DOUBLE_EQ(g[idx], g_expected[idx]);
+}
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "polo/utility/random.hpp"
+#include "polo/utility/sampler.hpp"
+#include "gtest/gtest.h"
+
+TEST(Philox4x32, KnownAnswers) {
+  using philox = polo::utility::random::philox4x32;
+
+  const auto zeros = philox::block({{0, 0, 0, 0}}, {{0, 0}});
+  const std::array<std::uint32_t, 4> expected1{
+      {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}};
+  EXPECT_EQ(zeros, expected1);
+
+  const auto ones = philox::block({{0xffffffff, 0xffffffff, 0xffffffff,
+                                    0xffffffff}},
+                                  {{0xffffffff, 0xffffffff}});
+  const std::array<std::uint32_t, 4> expected2{
+      {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}};
+  EXPECT_EQ(ones, expected2);
+
+  const auto pi = philox::block({{0x243f6a88, 0x85a308d3, 0x13198a2e,
+                                  0x03707344}},
+                                {{0xa4093822, 0x299f31d0}});
+  const std::array<std::uint32_t, 4> expected3{
+      {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+  EXPECT_EQ(pi, expected3);
+}
+
+template <class generator_t> void discard_equivalence() {
+  generator_t gen1(42), gen2(42);
+  for (int n = 0; n < 7; n++)
+    gen1();
+  gen2.discard(7);
+  EXPECT_TRUE(gen1 == gen2);
+  EXPECT_EQ(gen1(), gen2());
+}
+
+template <class generator_t> void generate_equivalence() {
+  generator_t gen1(7), gen2(7);
+  std::vector<typename generator_t::result_type> batch(103);
+  gen1();
+  gen2();
+  gen1.generate(std::begin(batch), std::end(batch));
+  for (const auto value : batch)
+    EXPECT_EQ(value, gen2());
+  EXPECT_EQ(gen1(), gen2());
+}
+
+template <class generator_t> void split_streams() {
+  generator_t parent(3), replay(3);
+  generator_t child1 = polo::utility::random::split(parent);
+  generator_t child2 = polo::utility::random::split(parent);
+  generator_t again1 = polo::utility::random::split(replay);
+  generator_t again2 = polo::utility::random::split(replay);
+
+  std::vector<typename generator_t::result_type> v1(64), v2(64);
+  child1.generate(std::begin(v1), std::end(v1));
+  child2.generate(std::begin(v2), std::end(v2));
+  EXPECT_NE(v1, v2);
+
+  for (const auto value : v1)
+    EXPECT_EQ(value, again1());
+  for (const auto value : v2)
+    EXPECT_EQ(value, again2());
+}
+
+// Splitting a child must not reproduce what its parent, or a sibling, hands
+// out on a later split.
+template <class generator_t> void nested_splits() {
+  generator_t root(3);
+  generator_t child = polo::utility::random::split(root);
+  generator_t grandchild = polo::utility::random::split(child);
+  generator_t sibling = polo::utility::random::split(root);
+  generator_t nephew = polo::utility::random::split(sibling);
+
+  std::vector<std::vector<typename generator_t::result_type>> streams;
+  for (generator_t *gen : {&root, &child, &grandchild, &sibling, &nephew}) {
+    streams.emplace_back(64);
+    gen->generate(std::begin(streams.back()), std::end(streams.back()));
+  }
+  for (std::size_t i = 0; i < streams.size(); i++)
+    for (std::size_t j = i + 1; j < streams.size(); j++)
+      EXPECT_NE(streams[i], streams[j]);
+}
+
+TEST(Philox4x32, Discard) {
+  discard_equivalence<polo::utility::random::philox4x32>();
+}
+TEST(Philox4x32, Generate) {
+  generate_equivalence<polo::utility::random::philox4x32>();
+}
+TEST(Philox4x32, Split) { split_streams<polo::utility::random::philox4x32>(); }
+TEST(Philox4x32, NestedSplits) {
+  nested_splits<polo::utility::random::philox4x32>();
+}
+TEST(Philox4x32, SplitStreamsAreDisjoint) {
+  using philox = polo::utility::random::philox4x32;
+  philox parent(3, 0);
+  philox child = polo::utility::random::split(parent);
+  philox sibling = polo::utility::random::split(parent);
+
+  std::vector<std::uint32_t> v1(64), v2(64), v3(64);
+  child.generate(std::begin(v1), std::end(v1));
+  sibling.generate(std::begin(v2), std::end(v2));
+  for (std::uint64_t stream = 0; stream < 4; stream++) {
+    philox user(3, stream);
+    user.generate(std::begin(v3), std::end(v3));
+    EXPECT_NE(v1, v3);
+    EXPECT_NE(v2, v3);
+  }
+}
+
+TEST(Xoshiro256ss, Discard) {
+  discard_equivalence<polo::utility::random::xoshiro256ss>();
+}
+TEST(Xoshiro256ss, Generate) {
+  generate_equivalence<polo::utility::random::xoshiro256ss>();
+}
+TEST(Xoshiro256ss, Split) {
+  split_streams<polo::utility::random::xoshiro256ss>();
+}
+TEST(Xoshiro256ss, NestedSplits) {
+  nested_splits<polo::utility::random::xoshiro256ss>();
+}
+
+TEST(Sampler, CustomGenerator) {
+  using generator_t = polo::utility::random::philox4x32;
+  using sampler_t = polo::utility::sampler::uniform<int, generator_t>;
+  sampler_t s1(std::uniform_int_distribution<int>(0, 1000));
+  sampler_t s2(std::uniform_int_distribution<int>(0, 1000), generator_t{});
+  std::vector<int> v1(10), v2(10);
+  s1(std::begin(v1), std::end(v1));
+  s2(std::begin(v2), std::end(v2));
+  EXPECT_EQ(v1, v2);
+}
+
+TEST(Sampler, ReproducibleCopies) {
+  polo::utility::sampler::uniform<int> s1, s2;
+  s1.parameters(0, 1000);
+  s2.parameters(0, 1000);
+  auto c1 = s1;
+  auto c2 = s2;
+
+  std::vector<int> v1(10), v2(10);
+  c1(std::begin(v1), std::end(v1));
+  c2(std::begin(v2), std::end(v2));
+  EXPECT_EQ(v1, v2);
+}
+
+TEST(Sampler, CopyLeavesSource) {
+  using generator_t = polo::utility::random::xoshiro256ss;
+  using sampler_t = polo::utility::sampler::uniform<int, generator_t>;
+  sampler_t source(std::uniform_int_distribution<int>(0, 1000));
+  sampler_t copy(static_cast<const sampler_t &>(source));
+  sampler_t child = source.split();
+
+  std::vector<int> v1(10), v2(10), v3(10);
+  source(std::begin(v1), std::end(v1));
+  copy(std::begin(v2), std::end(v2));
+  child(std::begin(v3), std::end(v3));
+  EXPECT_EQ(v1, v2);
+  EXPECT_NE(v1, v3);
+}
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "polo/utility/sampler.hpp"
+#include "gtest/gtest.h"
+
+class AliasSampler : public polo::utility::sampler::alias<int>,
+                     public ::testing::Test {
+protected:
+  AliasSampler() : indices(1000) {}
+  void SetUp() override {
+    std::vector<double> probs(10000);
+    for (int idx = 0; idx < 9000; idx++)
+      probs[idx] = 1 + idx % 3;
+    parameters(std::begin(probs), std::end(probs));
+  }
+  void TearDown() override {}
+  ~AliasSampler() override = default;
+
+  std::vector<int> indices;
+};
+
+TEST_F(AliasSampler, Sorted) {
+  operator()(std::begin(indices), std::end(indices));
+  EXPECT_TRUE(std::is_sorted(std::begin(indices), std::end(indices)));
+}
+
+TEST_F(AliasSampler, Bounded) {
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_GE(indices.front(), 0);
+    EXPECT_LT(indices.back(), 9000);
+  }
+}
+
+TEST_F(AliasSampler, Distinct) {
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_EQ(std::adjacent_find(std::begin(indices), std::end(indices)),
+              std::end(indices));
+  }
+}
+
+TEST_F(AliasSampler, Frequencies) {
+  parameters({1, 2, 3, 4});
+  std::vector<int> index(1);
+  std::vector<double> counts(4);
+  const int N{100000};
+  for (int n = 0; n < N; n++) {
+    operator()(std::begin(index), std::end(index));
+    counts[index[0]]++;
+  }
+  for (int idx = 0; idx < 4; idx++)
+    EXPECT_NEAR(counts[idx] / N, (idx + 1) / 10.0, 0.01);
+}
+
+TEST_F(AliasSampler, Correction) {
+  parameters({1, 2, 3, 4});
+  const std::vector<int> sampled{0, 1, 2, 3};
+  std::vector<double> w(sampled.size());
+  correction(std::begin(sampled), std::end(sampled), std::begin(w));
+  for (int idx = 0; idx < 4; idx++)
+    EXPECT_DOUBLE_EQ(w[idx], 10.0 / (4 * (idx + 1)));
+}
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "polo/utility/sampler.hpp"
@@ -33,3 +35,30 @@ TEST_F(CustomSampler, Bounded) {
     EXPECT_LT(indices.back(), 9000);
   }
 }
+
+TEST_F(CustomSampler, Distinct) {
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_EQ(std::adjacent_find(std::begin(indices), std::end(indices)),
+              std::end(indices));
+  }
+}
+
+struct unit_loss {
+  double operator()(const double *, double *) const { return 0; }
+};
+
+template <class sampler_t, class = void>
+struct has_weighted : std::false_type {};
+template <class sampler_t>
+struct has_weighted<sampler_t,
+                    decltype(std::declval<const sampler_t &>().weighted(
+                                 unit_loss{}),
+                             void())> : std::true_type {};
+
+TEST(Sampler, WeightedRequiresProbability) {
+  EXPECT_FALSE(has_weighted<polo::utility::sampler::custom<int>>::value);
+  EXPECT_FALSE(has_weighted<polo::utility::sampler::uniform<int>>::value);
+  EXPECT_TRUE(has_weighted<polo::utility::sampler::alias<int>>::value);
+  EXPECT_TRUE(has_weighted<polo::utility::sampler::dynamic<int>>::value);
+}
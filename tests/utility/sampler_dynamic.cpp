@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "polo/utility/sampler.hpp"
+#include "gtest/gtest.h"
+
+class DynamicSampler : public polo::utility::sampler::dynamic<int>,
+                       public ::testing::Test {
+protected:
+  DynamicSampler() : indices(100) {}
+  void SetUp() override {
+    std::vector<double> weights(1000, 1);
+    parameters(std::begin(weights), std::end(weights));
+  }
+  void TearDown() override {}
+  ~DynamicSampler() override = default;
+
+  std::vector<int> indices;
+};
+
+TEST_F(DynamicSampler, Distinct) {
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_TRUE(std::is_sorted(std::begin(indices), std::end(indices)));
+    EXPECT_EQ(std::adjacent_find(std::begin(indices), std::end(indices)),
+              std::end(indices));
+  }
+}
+
+TEST_F(DynamicSampler, Update) {
+  for (int idx = 500; idx < 1000; idx++)
+    update(idx, 0);
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_GE(indices.front(), 0);
+    EXPECT_LT(indices.back(), 500);
+  }
+
+  const std::vector<int> changed{0, 999};
+  const std::vector<double> weights{0, 1};
+  update(std::begin(changed), std::end(changed), std::begin(weights));
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_GE(indices.front(), 1);
+    EXPECT_LE(indices.back(), 999);
+  }
+}
+
+TEST_F(DynamicSampler, Frequencies) {
+  parameters({1, 1, 1, 1});
+  update(3, 4);
+  update(0, 2);
+  std::vector<int> index(1);
+  std::vector<double> counts(4);
+  const int N{100000};
+  for (int n = 0; n < N; n++) {
+    operator()(std::begin(index), std::end(index));
+    counts[index[0]]++;
+  }
+  const std::vector<double> expected{0.25, 0.125, 0.125, 0.5};
+  for (int idx = 0; idx < 4; idx++)
+    EXPECT_NEAR(counts[idx] / N, expected[idx], 0.01);
+}
+
+TEST_F(DynamicSampler, SharedWeights) {
+  polo::utility::sampler::dynamic<int> copy(*this);
+  std::vector<double> w(1);
+  const std::vector<int> sampled{7};
+  update(7, 1000);
+  copy.correction(std::begin(sampled), std::end(sampled), std::begin(w));
+  EXPECT_DOUBLE_EQ(w[0], 1999.0 / 1000 / 1000);
+}
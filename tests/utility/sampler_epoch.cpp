@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "polo/utility/sampler.hpp"
+#include "gtest/gtest.h"
+
+class EpochSampler : public polo::utility::sampler::epoch<int>,
+                     public ::testing::Test {
+protected:
+  EpochSampler() : indices(100) {}
+  void SetUp() override { parameters(0, 999); }
+  void TearDown() override {}
+  ~EpochSampler() override = default;
+
+  std::vector<int> indices;
+};
+
+TEST_F(EpochSampler, Sorted) {
+  operator()(std::begin(indices), std::end(indices));
+  EXPECT_TRUE(std::is_sorted(std::begin(indices), std::end(indices)));
+}
+
+TEST_F(EpochSampler, Bounded) {
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_GE(indices.front(), 0);
+    EXPECT_LE(indices.back(), 999);
+  }
+}
+
+TEST_F(EpochSampler, CoversEpoch) {
+  for (int e = 0; e < 3; e++) {
+    std::vector<int> seen;
+    for (int n = 0; n < 10; n++) {
+      operator()(std::begin(indices), std::end(indices));
+      seen.insert(std::end(seen), std::begin(indices), std::end(indices));
+    }
+    std::sort(std::begin(seen), std::end(seen));
+    for (int idx = 0; idx < 1000; idx++)
+      EXPECT_EQ(seen[idx], idx);
+  }
+  EXPECT_EQ(epochs(), 2);
+}
+
+TEST(EpochSamplerRemainder, CoversEpoch) {
+  polo::utility::sampler::epoch<int> sampler;
+  sampler.parameters(0, 9);
+  std::vector<int> batch(3), counts(10);
+  for (int n = 0; n < 10; n++) {
+    sampler(std::begin(batch), std::end(batch));
+    EXPECT_EQ(std::adjacent_find(std::begin(batch), std::end(batch)),
+              std::end(batch));
+    for (const int idx : batch)
+      counts[idx]++;
+    const auto range =
+        std::minmax_element(std::begin(counts), std::end(counts));
+    EXPECT_LE(*range.second - *range.first, 1);
+  }
+  for (const int count : counts)
+    EXPECT_EQ(count, 3);
+  EXPECT_EQ(sampler.epochs(), 2);
+}
+
+TEST(EpochSamplerRemainder, LargerThanRange) {
+  polo::utility::sampler::epoch<int> sampler;
+  sampler.parameters(0, 9);
+  std::vector<int> batch(11);
+  EXPECT_THROW(sampler(std::begin(batch), std::end(batch)), std::domain_error);
+}
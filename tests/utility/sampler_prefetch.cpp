@@ -0,0 +1,97 @@
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "polo/loss/leastsquares.hpp"
+#include "polo/utility/prefetch.hpp"
+#include "gtest/gtest.h"
+
+class PrefetchSampler : public ::testing::Test {
+protected:
+  PrefetchSampler() : indices(10), x(5) {}
+  void SetUp() override {
+    std::vector<int> row_ptr{0}, cols;
+    std::vector<double> values, labels;
+    for (int row = 0; row < 100; row++) {
+      cols.push_back(row % 5);
+      values.push_back(row + 1);
+      if (row % 3 == 0) {
+        cols.push_back((row + 2) % 5);
+        values.push_back(-row);
+      }
+      row_ptr.push_back(cols.size());
+      labels.push_back(row % 7);
+    }
+    data = polo::loss::data<double, int>(
+        polo::matrix::smatrix<double, int>(100, 5, row_ptr, cols, values),
+        labels);
+    for (int idx = 0; idx < 5; idx++)
+      x[idx] = 0.1 * idx - 0.2;
+  }
+  void TearDown() override {}
+  ~PrefetchSampler() override = default;
+
+  polo::loss::data<double, int> data;
+  std::vector<int> indices;
+  std::vector<double> x;
+};
+
+TEST_F(PrefetchSampler, Block) {
+  polo::utility::sampler::prefetch<double, int> sampler(data);
+  sampler.parameters(0, 99);
+  for (int n = 0; n < 25; n++) {
+    sampler(std::begin(indices), std::end(indices));
+    const auto block = sampler.block();
+    ASSERT_EQ(block.nsamples(), 10);
+    int row{0};
+    for (const int idx : indices) {
+      EXPECT_EQ(block.matrix()->getrow(row), data.matrix()->getrow(idx));
+      EXPECT_EQ(block.matrix()->colindices(row),
+                data.matrix()->colindices(idx));
+      EXPECT_DOUBLE_EQ((*block.labels())[row], (*data.labels())[idx]);
+      row++;
+    }
+  }
+}
+
+TEST_F(PrefetchSampler, Loss) {
+  using prefetch_t = polo::utility::sampler::prefetch<double, int>;
+  prefetch_t sampler(data);
+  sampler.parameters(0, 99);
+  polo::loss::leastsquares<double, int> loss(data);
+  auto blockwise = sampler.blockwise(loss);
+
+  std::vector<double> expected(5), actual(5);
+  for (int n = 0; n < 25; n++) {
+    sampler(std::begin(indices), std::end(indices));
+    const int *ib = indices.data();
+    const int *ie = ib + indices.size();
+    const double f1 = loss(x.data(), expected.data(), ib, ie);
+    const double f2 = blockwise(x.data(), actual.data(), ib, ie);
+    EXPECT_DOUBLE_EQ(f1, f2);
+    for (int idx = 0; idx < 5; idx++)
+      EXPECT_NEAR(actual[idx], expected[idx], 1E-12);
+  }
+}
+
+TEST_F(PrefetchSampler, MismatchedIndices) {
+  polo::utility::sampler::prefetch<double, int> sampler(data);
+  sampler.parameters(0, 99);
+  polo::loss::leastsquares<double, int> loss(data);
+  auto blockwise = sampler.blockwise(loss);
+
+  std::vector<double> expected(5), actual(5);
+  for (int n = 0; n < 25; n++) {
+    sampler(std::begin(indices), std::end(indices));
+    std::vector<int> other(indices);
+    for (int &idx : other)
+      idx = (idx + 1) % 100;
+    const int *ib = other.data();
+    const int *ie = ib + other.size();
+    const double f1 = loss(x.data(), expected.data(), ib, ie);
+    const double f2 = blockwise(x.data(), actual.data(), ib, ie);
+    EXPECT_DOUBLE_EQ(f1, f2);
+    for (int idx = 0; idx < 5; idx++)
+      EXPECT_NEAR(actual[idx], expected[idx], 1E-12);
+  }
+}
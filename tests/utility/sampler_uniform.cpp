@@ -28,3 +28,18 @@ TEST_F(UniformSampler, Bounded) {
     EXPECT_LE(indices.back(), 10000);
   }
 }
+
+TEST_F(UniformSampler, Distinct) {
+  for (int n = 0; n < 100; n++) {
+    operator()(std::begin(indices), std::end(indices));
+    EXPECT_EQ(std::adjacent_find(std::begin(indices), std::end(indices)),
+              std::end(indices));
+  }
+}
+
+TEST_F(UniformSampler, Exhaustive) {
+  std::vector<int> all(10001);
+  operator()(std::begin(all), std::end(all));
+  for (int idx = 0; idx < 10001; idx++)
+    EXPECT_EQ(all[idx], idx);
+}